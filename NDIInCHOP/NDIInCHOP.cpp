@@ -24,6 +24,8 @@ NDIInCHOP::NDIInCHOP(const OP_NodeInfo *) {
 		return;
 	}
 
+	_prober = SourceProber::acquire();
+
 	updateBuffer();
 
 	_audioFrame.p_data = nullptr;
@@ -40,6 +42,7 @@ NDIInCHOP::~NDIInCHOP() {
 	if(_pollBuffer.joinable())
 		_pollBuffer.detach();
 
+	_prober.reset();
 	NDIlib_destroy();
 }
 
@@ -147,6 +150,9 @@ void NDIInCHOP::getGeneralInfo(CHOP_GeneralInfo* ginfo,
 		_state.sourcesAdresses.push_back(sources[i].p_url_address);
 	}
 
+	if (_prober && inputs->getParInt("Probesources"))
+		_prober->request(sources, _state.sourcesCount);
+
 	// Are we connected to a source ?
 	if (_receiver != nullptr) {
 		// Yes, nothing else to do
@@ -261,7 +267,7 @@ void NDIInCHOP::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan* chan, void *) {
 
 bool NDIInCHOP::getInfoDATSize(OP_InfoDATSize * infoSize, void *) {
 	infoSize->rows = _state.sourcesCount + 1;
-	infoSize->cols = 2;
+	infoSize->cols = 2 + static_cast<int32_t>(SourceProber::getDescriptionHeaders().size());
 	infoSize->byColumn = false;
 	return true;
 }
@@ -271,11 +277,28 @@ void NDIInCHOP::getInfoDATEntries(int32_t index, int32_t,
 	if(index == 0) {
 		entries->values[0]->setString("Sources");
 		entries->values[1]->setString("Addresses");
+
+		const std::vector<std::string> &headers = SourceProber::getDescriptionHeaders();
+
+		for(size_t i = 0; i < headers.size(); ++i)
+			entries->values[2 + i]->setString(headers[i].c_str());
+
 		return;
 	}
 
 	entries->values[0]->setString(_state.sourcesNames[index - 1].c_str());
 	entries->values[1]->setString(_state.sourcesAdresses[index - 1].c_str());
+
+	// Format of the source, once probed
+	SourceProber::Format format;
+
+	if(_prober)
+		_prober->getFormat(_state.sourcesNames[index - 1], format);
+
+	const std::vector<std::string> description = SourceProber::describe(format);
+
+	for(size_t i = 0; i < description.size(); ++i)
+		entries->values[2 + i]->setString(description[i].c_str());
 }
 
 void NDIInCHOP::setupParameters(OP_ParameterManager * manager, void *) {
@@ -307,6 +330,13 @@ void NDIInCHOP::setupParameters(OP_ParameterManager * manager, void *) {
 	const char * bandwidthValues[] = {"High", "Low"};
 	manager->appendMenu(bandwidth, 2, bandwidthValues, bandwidthValues);
 
+	OP_NumericParameter probeSources;
+	probeSources.name = "Probesources";
+	probeSources.label = "Probe Sources Formats";
+	probeSources.page = "NDI In";
+	probeSources.defaultValues[0] = 1;
+	manager->appendToggle(probeSources);
+
 	OP_NumericParameter bufferSize;
 	bufferSize.name = "Buffersize";
 	bufferSize.label = "Buffer Size (s)";
@@ -11,9 +11,11 @@
 #include <mutex>
 #include <thread> 
 #include <functional>
+#include <memory>
 
 #include "../third-parties/CHOP_CPlusPlusBase.h"
 #include "../Utils/ringbuffer.hpp"
+#include "../Utils/source_prober.hpp"
 
 #include <Processing.NDI.Lib.h>
 
@@ -50,6 +52,9 @@ private:
 	NDIlib_find_instance_t _finder = nullptr;
 	NDIlib_recv_instance_t _receiver = nullptr;
 
+	// Formats of the discovered sources, for the Info DAT
+	std::shared_ptr<SourceProber> _prober;
+
 	std::mutex _feedMutex;
 
 	NDIlib_audio_frame_v2_t _audioFrame;
@@ -9,10 +9,12 @@
 #include "NDIInTOP.h"
 
 #include "../Utils/fast_memcpy.h"
+#include "../Utils/worker_pool.hpp"
 
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <algorithm>
 #include <cmath>
 #include <random>
 #include <chrono>
@@ -25,11 +27,23 @@ NDIInTOP::NDIInTOP(const OP_NodeInfo *) {
 		_state.errorMessage = "Could not initialized NDI. CPU may be unsupported.";
 		return;
 	}
+
+	_prober = SourceProber::acquire();
 }
 
 NDIInTOP::~NDIInTOP() {
-	NDIlib_recv_destroy(_receiver);
+	setSyncGroup("");
+	stopReceiving();
+
+	if(_recorder)
+		_recorder->close();
+
+	// Wait for the recordings closing in the background
+	for(auto &closing: _closingRecorders)
+		closing.second.wait();
+
 	NDIlib_find_destroy(_finder);
+	_prober.reset();
 	NDIlib_destroy();
 }
 
@@ -43,10 +57,16 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 		// get parameters
 		_params.active = inputs->getParInt("Active");
 
+		_params.record = inputs->getParInt("Record");
+		_params.recordFile = inputs->getParString("Recordfile");
+		_params.recordQueue = inputs->getParInt("Recordqueue");
+		updateRecorder();
+
 		if (!_params.active) {
+			setSyncGroup("");
+
 			if (_receiver != nullptr) {
-				NDIlib_recv_destroy(_receiver);
-				_receiver = nullptr;
+				stopReceiving();
 			}
 
 			if (_finder != nullptr) {
@@ -57,6 +77,80 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 			return;
 		}
 
+		setSyncGroup(inputs->getParString("Syncgroup"));
+
+		// Crop, scaling and deinterlacing, applied by the receive thread
+		{
+			std::unique_lock<std::mutex> settingsLock(_settingsMutex);
+			_settings.cropLeft = inputs->getParDouble("Cropleft");
+			_settings.cropRight = inputs->getParDouble("Cropright");
+			_settings.cropTop = inputs->getParDouble("Croptop");
+			_settings.cropBottom = inputs->getParDouble("Cropbottom");
+
+			_settings.customResolution = inputs->getParInt("Customresolution");
+			inputs->getParInt2("Resolution", _settings.width, _settings.height);
+			_settings.filter = std::string(inputs->getParString("Scalefilter")) == "Bilinear" ?
+				VideoScaler::Filter::Bilinear :
+				VideoScaler::Filter::Box;
+
+			const std::string deinterlacePar = inputs->getParString("Deinterlace");
+
+			if(deinterlacePar == "Weave")
+				_settings.deinterlaceMode = Deinterlacer::Mode::Weave;
+			else if(deinterlacePar == "Bob")
+				_settings.deinterlaceMode = Deinterlacer::Mode::Bob;
+			else
+				_settings.deinterlaceMode = Deinterlacer::Mode::MotionAdaptive;
+
+			_settings.fieldRate = inputs->getParInt("Fieldrate");
+			_settings.motionThreshold = static_cast<uint8_t>(inputs->getParInt("Motionthreshold"));
+
+			const std::string syncModePar = inputs->getParString("Syncmode");
+
+			if(syncModePar == "Framesync")
+				_params.syncMode = SyncMode::FrameSync;
+			else if(syncModePar == "Cookclock")
+				_params.syncMode = SyncMode::CookClock;
+			else
+				_params.syncMode = SyncMode::Latest;
+
+			_settings.analyze = inputs->getParInt("Analyze");
+			_settings.analysis.blackLevel = static_cast<uint8_t>(inputs->getParInt("Blacklevel"));
+			_settings.analysis.blackRatio = inputs->getParDouble("Blackratio");
+			_settings.analysis.freezeFrames = inputs->getParInt("Freezeframes");
+		}
+
+		_params.syncLatency = static_cast<int64_t>(inputs->getParDouble("Synclatency") * 10000.);
+
+		_params.syncOnTimecode = std::string(inputs->getParString("Syncon")) == "Timecode";
+		_params.syncTolerance = static_cast<int64_t>(inputs->getParDouble("Synctolerance") * 10000.);
+
+		// Receiving fields is decided when connecting
+		const bool deinterlacePar = std::string(inputs->getParString("Deinterlace")) != "Off";
+
+		if (deinterlacePar != _params.deinterlace && _receiver != nullptr) {
+			stopReceiving();
+		}
+
+		_params.deinterlace = deinterlacePar;
+
+		inputs->enablePar("Resolution", _settings.customResolution);
+		inputs->enablePar("Fieldrate", _params.deinterlace);
+		inputs->enablePar("Motionthreshold", _params.deinterlace && _settings.deinterlaceMode == Deinterlacer::Mode::MotionAdaptive);
+		inputs->enablePar("Blacklevel", _settings.analyze);
+		inputs->enablePar("Blackratio", _settings.analyze);
+		inputs->enablePar("Freezeframes", _settings.analyze);
+
+		{
+			std::unique_lock<std::mutex> analysisLock(_analysisMutex);
+			_state.analysis = _analysis;
+		}
+
+		inputs->enablePar("Syncmode", _params.syncGroup.empty());
+		inputs->enablePar("Synclatency", _params.syncGroup.empty() && _params.syncMode != SyncMode::Latest);
+		inputs->enablePar("Syncon", !_params.syncGroup.empty());
+		inputs->enablePar("Synctolerance", !_params.syncGroup.empty());
+
 		// Bandwidth
 		std::string bandwidthParStr = inputs->getParString("Bandwidth");
 		NDIlib_recv_bandwidth_e bandwidthPar;
@@ -69,8 +163,7 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 		// Check if requested bandwidth has changed
 		if (bandwidthPar != _params.bandwidth && _receiver != nullptr) {
 			// Requested source has changed, close current connection
-			NDIlib_recv_destroy(_receiver);
-			_receiver = nullptr;
+			stopReceiving();
 		}
 
 		_params.bandwidth = bandwidthPar;
@@ -111,8 +204,7 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 		// Check if requested source changed
 		if (sourceNamePar != _params.sourceName && _receiver != nullptr) {
 			// Requested source has changed, close current connection
-			NDIlib_recv_destroy(_receiver);
-			_receiver = nullptr;
+			stopReceiving();
 		}
 
 		_params.sourceName = sourceNamePar;
@@ -131,6 +223,9 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 			_state.sourcesAdresses.push_back(sources[i].p_url_address);
 		}
 
+		if (_prober && inputs->getParInt("Probesources"))
+			_prober->request(sources, _state.sourcesCount);
+
 		// Are we connected to a source ?
 		if (_receiver == nullptr) {
 			// No, check if one source match the requested one
@@ -141,7 +236,7 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 				// Connect to the source
 				NDIlib_recv_create_v3_t receiverOptions;
 				receiverOptions.color_format = NDIlib_recv_color_format_BGRX_BGRA;
-				receiverOptions.allow_video_fields = false;
+				receiverOptions.allow_video_fields = _params.deinterlace;
 				receiverOptions.bandwidth = _params.bandwidth;
 				receiverOptions.source_to_connect_to = *(sources + i);
 
@@ -156,6 +251,7 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 				_state.warningMessage = "";
 
 				// we are connected, end here
+				startReceiving();
 				break;
 			}
 
@@ -167,13 +263,8 @@ void NDIInTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
 			}
 		}
 
-		// Get the latest frames
-		NDIlib_frame_type_e frameType = NDIlib_frame_type_none;
-
-		do {
-			frameType = NDIlib_recv_capture_v2(_receiver, &_videoFrame, nullptr, nullptr, 10);
-		} while (frameType != NDIlib_frame_type_none && frameType != NDIlib_frame_type_video);
-
+		updateQueueCapacity();
+		selectFrame(inputs->getTimeInfo());
 
 		ginfo->clearBuffers = false;
 	} catch (std::runtime_error &exc) {
@@ -191,14 +282,25 @@ bool NDIInTOP::getOutputFormat(TOP_OutputFormat * format,
 		return false;
 	}
 
+	// Use the size of the frame execute will receive
+	const VideoFrame * frame = _nextFrame ? _nextFrame.get() : _frontFrame.get();
+
+	// Nothing received yet
+	if(frame == nullptr) {
+		return false;
+	}
+
+	_state.outputWidth = frame->width;
+	_state.outputHeight = frame->height;
+
 	// Yes, set parameters to 8bits RGBA
 	format->redChannel = true;
 	format->greenChannel = true;
 	format->blueChannel = true;
 	format->alphaChannel = true;
 	format->bitsPerChannel = 8;
-	format->width = _videoFrame.xres;
-	format->height = _videoFrame.yres;
+	format->width = _state.outputWidth;
+	format->height = _state.outputHeight;
 
 	return true;
 }
@@ -214,35 +316,50 @@ void NDIInTOP::execute(TOP_OutputFormatSpecs * output,
 		return;
 	}
 
-	if (_videoFrame.p_data == nullptr) {
+	// Nothing new to show, keep the previous texture
+	if (!_nextFrame) {
 		output->newCPUPixelDataLocation = -1;
 		return;
 	}
 
-	// Is the received video frame supported ?
-	// We check against the TD-provided buffers as they will have different resolutions than the requested ones if we exceed the TD licence limitation.
-	if(_videoFrame.xres != output->width || _videoFrame.yres != output->height) {
-		_state.isErrored = true;
-		_state.errorMessage = "TouchDesigner does not support the received video resolution (" + std::to_string(_videoFrame.xres) + "x" + std::to_string(_videoFrame.yres) + ").";
-		NDIlib_recv_free_video_v2(_receiver, &_videoFrame);
-		_videoFrame.p_data = nullptr;
-		return;
-	}
+	_frames.recycle(std::move(_frontFrame));
+	_frontFrame = std::move(_nextFrame);
 
 	// We're good
 	_state.isErrored = false;
 
-	// Copy frame
-	memcpy_fast(output->cpuPixelData[0], _videoFrame.p_data, _videoFrame.xres * _videoFrame.yres * 4);
+	// Does the frame fit the TD-provided buffers ?
+	if(_frontFrame->width == output->width && _frontFrame->height == output->height) {
+		memcpy_fast(output->cpuPixelData[0], _frontFrame->data.data(), _frontFrame->width * _frontFrame->height * 4);
+		return;
+	}
+
+	// No. Buffers smaller than what we asked for mean we exceed the TD licence
+	// limitation, have the receive thread fit the next frames in them.
+	if(output->width < _state.outputWidth || output->height < _state.outputHeight) {
+		std::unique_lock<std::mutex> settingsLock(_settingsMutex);
+		_settings.maxWidth = output->width;
+		_settings.maxHeight = output->height;
+	}
+
+	// Scale this one here
+	VideoScaler::Filter filter;
+
+	{
+		std::unique_lock<std::mutex> settingsLock(_settingsMutex);
+		filter = _settings.filter;
+	}
 
-	NDIlib_recv_free_video_v2(_receiver, &_videoFrame);
-	_videoFrame.p_data = nullptr;
+	_fallbackScaler.configure(_frontFrame->width, _frontFrame->height, output->width, output->height, filter);
+	_fallbackScaler.process(_frontFrame->data.data(), _frontFrame->width * 4,
+							reinterpret_cast<uint8_t *>(output->cpuPixelData[0]), output->width * 4,
+							_pool.get());
 }
 
 int32_t NDIInTOP::getNumInfoCHOPChans(void *) {
 	// We return the number of channel we want to output to any Info CHOP
 	// connected, num_sources
-	return 3;
+	return 43;
 }
 
 void NDIInTOP::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan * chan, void *) {
@@ -257,17 +374,130 @@ void NDIInTOP::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan * chan, void *) {
 			break;
 		case 2:  // fps
 			chan->name->setString("received_fps");
-			if(_receiver == nullptr)
+			if(_receiver == nullptr || !_frontFrame || _frontFrame->frameRateD == 0)
 				chan->value = 0;
 			else
-				chan->value = static_cast<float>(_videoFrame.frame_rate_N / _videoFrame.frame_rate_D);
+				chan->value = static_cast<float>(_frontFrame->frameRateN) / _frontFrame->frameRateD;
+			break;
+		case 3:  // source_width
+			chan->name->setString("source_width");
+			chan->value = _frontFrame ? static_cast<float>(_frontFrame->sourceWidth) : 0;
+			break;
+		case 4:  // source_height
+			chan->name->setString("source_height");
+			chan->value = _frontFrame ? static_cast<float>(_frontFrame->sourceHeight) : 0;
+			break;
+		case 5:  // queue_depth
+			chan->name->setString("queue_depth");
+			chan->value = static_cast<float>(_frames.size());
+			break;
+		case 6:  // frames_dropped
+			chan->name->setString("frames_dropped");
+			chan->value = static_cast<float>(_frames.getDroppedCount());
+			break;
+		case 7:  // frames_repeated
+			chan->name->setString("frames_repeated");
+			chan->value = static_cast<float>(_state.repeatedFrames);
+			break;
+		case 8:  // sync_phase_error
+			chan->name->setString("sync_phase_error_ms");
+			chan->value = static_cast<float>(_state.phaseError / 10000.);
+			break;
+		case 9:  // sync_phase_error_avg
+			chan->name->setString("sync_phase_error_avg_ms");
+			chan->value = static_cast<float>(_state.averagePhaseError / 10000.);
+			break;
+		case 10:  // cook_jitter
+			chan->name->setString("cook_jitter_ms");
+			chan->value = static_cast<float>(_state.cookJitter / 10000.);
+			break;
+		case 11:  // sync_group_members
+			chan->name->setString("sync_group_members");
+			chan->value = _syncGroup ? static_cast<float>(_syncGroup->getStats().membersCount) : 0;
+			break;
+		case 12:  // sync_group_released
+			chan->name->setString("sync_group_released");
+			chan->value = _syncGroup ? static_cast<float>(_syncGroup->getStats().releasedFrames) : 0;
+			break;
+		case 13:  // sync_group_stalls
+			chan->name->setString("sync_group_stalls");
+			chan->value = _syncGroup ? static_cast<float>(_syncGroup->getStats().stalledCooks) : 0;
+			break;
+		case 14:  // sync_group_skew
+			chan->name->setString("sync_group_skew_ms");
+			chan->value = _syncGroup ? static_cast<float>(_syncGroup->getStats().skew / 10000.) : 0;
+			break;
+		case 15:  // sync_group_max_skew
+			chan->name->setString("sync_group_max_skew_ms");
+			chan->value = _syncGroup ? static_cast<float>(_syncGroup->getStats().maxSkew / 10000.) : 0;
+			break;
+		case 16:  // luma_average
+			chan->name->setString("luma_average");
+			chan->value = static_cast<float>(_state.analysis.averageLuma / 255.);
 			break;
+		case 17:  // black
+			chan->name->setString("black");
+			chan->value = _state.analysis.isBlack;
+			break;
+		case 18:  // black_ratio
+			chan->name->setString("black_ratio");
+			chan->value = static_cast<float>(_state.analysis.blackRatio);
+			break;
+		case 19:  // black_frames
+			chan->name->setString("black_frames");
+			chan->value = static_cast<float>(_state.analysis.blackFrames);
+			break;
+		case 20:  // frozen
+			chan->name->setString("frozen");
+			chan->value = _state.analysis.isFrozen;
+			break;
+		case 21:  // identical_frames
+			chan->name->setString("identical_frames");
+			chan->value = static_cast<float>(_state.analysis.identicalFrames);
+			break;
+		case 22:  // frozen_frames
+			chan->name->setString("frozen_frames");
+			chan->value = static_cast<float>(_state.analysis.frozenFrames);
+			break;
+		case 39:  // record_written_frames
+			chan->name->setString("record_written_frames");
+			chan->value = _recorder ? static_cast<float>(_recorder->getWrittenCount()) : 0;
+			break;
+		case 40:  // record_dropped_frames
+			chan->name->setString("record_dropped_frames");
+			chan->value = _recorder ? static_cast<float>(_recorder->getDroppedCount()) : 0;
+			break;
+		case 41:  // record_queue_depth
+			chan->name->setString("record_queue_depth");
+			chan->value = _recorder ? static_cast<float>(_recorder->getQueueSize()) : 0;
+			break;
+		case 42:  // record_written_mb
+			chan->name->setString("record_written_mb");
+			chan->value = _recorder ? static_cast<float>(_recorder->getBytesWritten() / 1048576.) : 0;
+			break;
+		default: {  // luma_hist_N, part of the pixels in each sixteenth of the luma range
+			const int bin = index - 23;
+
+			if(bin < 0 || bin >= 16)
+				break;
+
+			chan->name->setString(("luma_hist_" + std::to_string(bin)).c_str());
+
+			uint64_t count = 0;
+
+			for(int i = bin * 16; i < (bin + 1) * 16; ++i)
+				count += _state.analysis.histogram[i];
+
+			chan->value = _state.analysis.pixelsCount > 0 ?
+				static_cast<float>(static_cast<double>(count) / _state.analysis.pixelsCount) :
+				0;
+		} break;
 	}
 }
 
 bool	NDIInTOP::getInfoDATSize(OP_InfoDATSize * infoSize, void *) {
 	infoSize->rows = _state.sourcesCount + 1;
-	infoSize->cols = 2;
+	infoSize->cols = 2 + static_cast<int32_t>(SourceProber::getDescriptionHeaders().size());
 	// Setting this to false means we'll be assigning values to the table
 	// one row at a time. True means we'll do it one column at a time.
 	infoSize->byColumn = false;
@@ -279,11 +509,28 @@ void NDIInTOP::getInfoDATEntries(int32_t index, int32_t,
 	if(index == 0) {
 		entries->values[0]->setString("Sources");
 		entries->values[1]->setString("Addresses");
+
+		const std::vector<std::string> &headers = SourceProber::getDescriptionHeaders();
+
+		for(size_t i = 0; i < headers.size(); ++i)
+			entries->values[2 + i]->setString(headers[i].c_str());
+
 		return;
 	}
 
 	entries->values[0]->setString(_state.sourcesNames[index - 1].c_str());
 	entries->values[1]->setString(_state.sourcesAdresses[index - 1].c_str());
+
+	// Format of the source, once probed
+	SourceProber::Format format;
+
+	if(_prober)
+		_prober->getFormat(_state.sourcesNames[index - 1], format);
+
+	const std::vector<std::string> description = SourceProber::describe(format);
+
+	for(size_t i = 0; i < description.size(); ++i)
+		entries->values[2 + i]->setString(description[i].c_str());
 }
 
 
@@ -316,6 +563,427 @@ void NDIInTOP::setupParameters(OP_ParameterManager * manager, void *) {
 	bandwidth.page = "NDI In";
 	const char * bandwidthValues[] = {"High", "Low"};
 	manager->appendMenu(bandwidth, 2, bandwidthValues, bandwidthValues);
+
+	OP_NumericParameter probeSources;
+	probeSources.name = "Probesources";
+	probeSources.label = "Probe Sources Formats";
+	probeSources.page = "NDI In";
+	probeSources.defaultValues[0] = 1;
+	manager->appendToggle(probeSources);
+
+	OP_NumericParameter customResolution;
+	customResolution.name = "Customresolution";
+	customResolution.label = "Custom Resolution";
+	customResolution.page = "NDI In";
+	customResolution.defaultValues[0] = 0;
+	manager->appendToggle(customResolution);
+
+	OP_NumericParameter resolution;
+	resolution.name = "Resolution";
+	resolution.label = "Resolution";
+	resolution.page = "NDI In";
+	resolution.defaultValues[0] = 1920;
+	resolution.defaultValues[1] = 1080;
+
+	for(int i = 0; i < 2; ++i) {
+		resolution.minValues[i] = 1;
+		resolution.clampMins[i] = true;
+		resolution.minSliders[i] = 1;
+		resolution.maxSliders[i] = 4096;
+	}
+
+	manager->appendInt(resolution, 2);
+
+	OP_StringParameter scaleFilter;
+	scaleFilter.name = "Scalefilter";
+	scaleFilter.label = "Scale Filter";
+	scaleFilter.page = "NDI In";
+	const char * scaleFilterValues[] = {"Box", "Bilinear"};
+	manager->appendMenu(scaleFilter, 2, scaleFilterValues, scaleFilterValues);
+
+	const char * cropNames[] = {"Cropleft", "Cropright", "Croptop", "Cropbottom"};
+	const char * cropLabels[] = {"Crop Left", "Crop Right", "Crop Top", "Crop Bottom"};
+	const double cropDefaults[] = {0, 1, 0, 1};
+
+	for(int i = 0; i < 4; ++i) {
+		OP_NumericParameter crop;
+		crop.name = cropNames[i];
+		crop.label = cropLabels[i];
+		crop.page = "Crop";
+		crop.defaultValues[0] = cropDefaults[i];
+		crop.minValues[0] = 0;
+		crop.maxValues[0] = 1;
+		crop.clampMins[0] = true;
+		crop.clampMaxes[0] = true;
+		crop.minSliders[0] = 0;
+		crop.maxSliders[0] = 1;
+		manager->appendFloat(crop);
+	}
+
+	OP_StringParameter deinterlace;
+	deinterlace.name = "Deinterlace";
+	deinterlace.label = "Deinterlace";
+	deinterlace.page = "NDI In";
+	deinterlace.defaultValue = "Off";
+	const char * deinterlaceNames[] = {"Off", "Weave", "Bob", "Motionadaptive"};
+	const char * deinterlaceLabels[] = {"Off", "Weave", "Bob", "Motion Adaptive"};
+	manager->appendMenu(deinterlace, 4, deinterlaceNames, deinterlaceLabels);
+
+	OP_NumericParameter fieldRate;
+	fieldRate.name = "Fieldrate";
+	fieldRate.label = "Output Field Rate";
+	fieldRate.page = "NDI In";
+	fieldRate.defaultValues[0] = 0;
+	manager->appendToggle(fieldRate);
+
+	OP_NumericParameter motionThreshold;
+	motionThreshold.name = "Motionthreshold";
+	motionThreshold.label = "Motion Threshold";
+	motionThreshold.page = "NDI In";
+	motionThreshold.defaultValues[0] = 12;
+	motionThreshold.minValues[0] = 0;
+	motionThreshold.maxValues[0] = 255;
+	motionThreshold.clampMins[0] = true;
+	motionThreshold.clampMaxes[0] = true;
+	motionThreshold.minSliders[0] = 0;
+	motionThreshold.maxSliders[0] = 64;
+	manager->appendInt(motionThreshold);
+
+	OP_StringParameter syncMode;
+	syncMode.name = "Syncmode";
+	syncMode.label = "Sync Mode";
+	syncMode.page = "NDI In";
+	syncMode.defaultValue = "Latest";
+	const char * syncModeNames[] = {"Latest", "Framesync", "Cookclock"};
+	const char * syncModeLabels[] = {"Latest Frame", "Frame Sync", "Cook Clock Aligned"};
+	manager->appendMenu(syncMode, 3, syncModeNames, syncModeLabels);
+
+	OP_NumericParameter syncLatency;
+	syncLatency.name = "Synclatency";
+	syncLatency.label = "Sync Latency (ms)";
+	syncLatency.page = "NDI In";
+	syncLatency.defaultValues[0] = 50;
+	syncLatency.minValues[0] = 0;
+	syncLatency.maxValues[0] = 500;
+	syncLatency.clampMins[0] = true;
+	syncLatency.clampMaxes[0] = true;
+	syncLatency.minSliders[0] = 0;
+	syncLatency.maxSliders[0] = 200;
+	manager->appendFloat(syncLatency);
+
+	OP_StringParameter syncGroup;
+	syncGroup.name = "Syncgroup";
+	syncGroup.label = "Sync Group";
+	syncGroup.defaultValue = "";
+	syncGroup.page = "NDI In";
+	manager->appendString(syncGroup);
+
+	OP_StringParameter syncOn;
+	syncOn.name = "Syncon";
+	syncOn.label = "Sync On";
+	syncOn.page = "NDI In";
+	syncOn.defaultValue = "Timestamp";
+	const char * syncOnNames[] = {"Timestamp", "Timecode"};
+	manager->appendMenu(syncOn, 2, syncOnNames, syncOnNames);
+
+	OP_NumericParameter syncTolerance;
+	syncTolerance.name = "Synctolerance";
+	syncTolerance.label = "Sync Tolerance (ms)";
+	syncTolerance.page = "NDI In";
+	syncTolerance.defaultValues[0] = 2;
+	syncTolerance.minValues[0] = 0;
+	syncTolerance.clampMins[0] = true;
+	syncTolerance.minSliders[0] = 0;
+	syncTolerance.maxSliders[0] = 20;
+	manager->appendFloat(syncTolerance);
+
+	OP_NumericParameter analyze;
+	analyze.name = "Analyze";
+	analyze.label = "Analyze";
+	analyze.page = "Analysis";
+	analyze.defaultValues[0] = 0;
+	manager->appendToggle(analyze);
+
+	OP_NumericParameter blackLevel;
+	blackLevel.name = "Blacklevel";
+	blackLevel.label = "Black Level";
+	blackLevel.page = "Analysis";
+	blackLevel.defaultValues[0] = 16;
+	blackLevel.minValues[0] = 0;
+	blackLevel.maxValues[0] = 255;
+	blackLevel.clampMins[0] = true;
+	blackLevel.clampMaxes[0] = true;
+	blackLevel.minSliders[0] = 0;
+	blackLevel.maxSliders[0] = 64;
+	manager->appendInt(blackLevel);
+
+	OP_NumericParameter blackRatio;
+	blackRatio.name = "Blackratio";
+	blackRatio.label = "Black Ratio";
+	blackRatio.page = "Analysis";
+	blackRatio.defaultValues[0] = .98;
+	blackRatio.minValues[0] = 0;
+	blackRatio.maxValues[0] = 1;
+	blackRatio.clampMins[0] = true;
+	blackRatio.clampMaxes[0] = true;
+	blackRatio.minSliders[0] = 0;
+	blackRatio.maxSliders[0] = 1;
+	manager->appendFloat(blackRatio);
+
+	OP_NumericParameter freezeFrames;
+	freezeFrames.name = "Freezeframes";
+	freezeFrames.label = "Freeze Frames";
+	freezeFrames.page = "Analysis";
+	freezeFrames.defaultValues[0] = 30;
+	freezeFrames.minValues[0] = 1;
+	freezeFrames.clampMins[0] = true;
+	freezeFrames.minSliders[0] = 1;
+	freezeFrames.maxSliders[0] = 300;
+	manager->appendInt(freezeFrames);
+
+	OP_NumericParameter record;
+	record.name = "Record";
+	record.label = "Record";
+	record.page = "Record";
+	record.defaultValues[0] = 0;
+	manager->appendToggle(record);
+
+	OP_StringParameter recordFile;
+	recordFile.name = "Recordfile";
+	recordFile.label = "Record File";
+	recordFile.page = "Record";
+	recordFile.defaultValue = "";
+	manager->appendFile(recordFile);
+
+	OP_NumericParameter recordQueue;
+	recordQueue.name = "Recordqueue";
+	recordQueue.label = "Record Queue (frames)";
+	recordQueue.page = "Record";
+	recordQueue.defaultValues[0] = 16;
+	recordQueue.minValues[0] = 1;
+	recordQueue.clampMins[0] = true;
+	recordQueue.minSliders[0] = 1;
+	recordQueue.maxSliders[0] = 64;
+	manager->appendInt(recordQueue);
+}
+
+void NDIInTOP::updateRecorder() {
+	const bool recording = _params.record && !_params.recordFile.empty();
+
+	std::shared_ptr<RawVideoWriter> recorder;
+
+	{
+		std::unique_lock<std::mutex> recorderLock(_recorderMutex);
+		recorder = _recorder;
+	}
+
+	// Keep going while nothing changed
+	if(recording && recorder && recorder->isOpen() && _params.recordFile == _state.recordFile) {
+		_state.recordError = recorder->getError();
+		return;
+	}
+
+	// A failed file is not retried until the parameters change
+	if(recording && recorder && !recorder->isOpen() && _params.recordFile == _state.recordFile)
+		return;
+
+	if(!recording && !recorder)
+		return;
+
+	// Stop the current recording. Closing waits for the queued frames to
+	// be written, it is done in the background.
+	if(recorder) {
+		{
+			std::unique_lock<std::mutex> recorderLock(_recorderMutex);
+			_recorder.reset();
+		}
+
+		closeRecorder(std::move(recorder), _state.recordFile);
+	}
+
+	_state.recordError = "";
+	_state.recordFile = "";
+
+	// Recording again to the same file has to wait for its index to be
+	// written
+	if(isRecorderClosing(_params.recordFile) || !recording)
+		return;
+
+	recorder = std::make_shared<RawVideoWriter>(_params.recordQueue);
+	_state.recordFile = _params.recordFile;
+
+	if(!recorder->open(_params.recordFile))
+		_state.recordError = recorder->getError();
+
+	std::unique_lock<std::mutex> recorderLock(_recorderMutex);
+	_recorder = recorder;
+}
+
+void NDIInTOP::closeRecorder(std::shared_ptr<RawVideoWriter> recorder, const std::string &file) {
+	// The receive thread may still hold a reference for a moment, its push
+	// is refused once closing started
+	_closingRecorders.emplace_back(file, std::async(std::launch::async, [recorder] {
+		recorder->close();
+	}));
+}
+
+bool NDIInTOP::isRecorderClosing(const std::string &file) {
+	bool closing = false;
+
+	for(auto it = _closingRecorders.begin(); it != _closingRecorders.end();) {
+		if(it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			it = _closingRecorders.erase(it);
+			continue;
+		}
+
+		if(it->first == file)
+			closing = true;
+
+		++it;
+	}
+
+	return closing;
+}
+
+void NDIInTOP::recordFrame(RawVideoWriter &recorder, const NDIlib_video_frame_v2_t &videoFrame) {
+	// Single fields hold half the lines of the frame
+	const bool isField = videoFrame.frame_format_type == NDIlib_frame_format_type_field_0 ||
+						 videoFrame.frame_format_type == NDIlib_frame_format_type_field_1;
+	const int lines = isField ? videoFrame.yres / 2 : videoFrame.yres;
+
+	RawVideoFile::FrameHeader header;
+	header.fourCC = static_cast<uint32_t>(videoFrame.FourCC);
+	header.frameFormatType = static_cast<uint32_t>(videoFrame.frame_format_type);
+	header.width = videoFrame.xres;
+	header.height = videoFrame.yres;
+	header.stride = videoFrame.line_stride_in_bytes;
+	header.frameRateN = videoFrame.frame_rate_N;
+	header.frameRateD = videoFrame.frame_rate_D;
+	header.timestamp = videoFrame.timestamp;
+	header.timecode = videoFrame.timecode;
+	header.dataSize = static_cast<uint64_t>(videoFrame.line_stride_in_bytes) * lines;
+
+	// Dropped and counted by the recorder when the disk falls behind
+	recorder.push(header, videoFrame.p_data);
+}
+
+void NDIInTOP::setSyncGroup(const std::string &name) {
+	if(name == _params.syncGroup)
+		return;
+
+	if(_syncGroup) {
+		_syncGroup->removeMember(&_frames);
+		_syncGroup.reset();
+	}
+
+	_params.syncGroup = name;
+
+	if(name.empty())
+		return;
+
+	_syncGroup = SyncGroup::join(name);
+	_syncGroup->addMember(&_frames);
+}
+
+void NDIInTOP::updateQueueCapacity() {
+	size_t capacity;
+
+	if(_params.syncMode == SyncMode::Latest && !_syncGroup) {
+		// The newest frame, and the second field of an interleaved frame
+		// waiting for its time
+		capacity = 3;
+	} else {
+		// Frames stay queued for the sync latency. Until a frame arrived,
+		// assume a fast source.
+		double frameRate = 60.;
+
+		if(_frontFrame && _frontFrame->frameRateN > 0 && _frontFrame->frameRateD > 0)
+			frameRate = static_cast<double>(_frontFrame->frameRateN) / _frontFrame->frameRateD;
+
+		const double latencyFrames = std::ceil(_params.syncLatency * frameRate / 10000000.);
+
+		// Room for the cook jitter, and for the other members of a sync
+		// group to catch up
+		const size_t margin = _syncGroup ? 8 : 4;
+
+		capacity = std::min(static_cast<size_t>(maxQueuedFrames), static_cast<size_t>(latencyFrames) + margin);
+	}
+
+	if(capacity != _frames.getCapacity())
+		_frames.setCapacity(capacity);
+}
+
+void NDIInTOP::selectFrame(const OP_TimeInfo * timeInfo) {
+	const int64_t now = ClockMapper::now();
+	std::unique_ptr<VideoFrame> frame;
+
+	if(_syncGroup) {
+		// Show the frame every member of the group has, or hold
+		int64_t key;
+
+		if(_syncGroup->resolve(timeInfo->absFrame, _params.syncOnTimecode, _params.syncTolerance, key))
+			frame = _frames.popMatching(key, _params.syncTolerance, _params.syncOnTimecode);
+
+		if(!frame) {
+			if(_frontFrame)
+				++_state.repeatedFrames;
+
+			return;
+		}
+
+		_frames.recycle(std::move(_nextFrame));
+		_nextFrame = std::move(frame);
+		return;
+	}
+
+	switch (_params.syncMode) {
+		case SyncMode::Latest:
+			// Whatever arrived last. Received frames are due on arrival, only
+			// the second field of an interleaved frame waits half a frame.
+			frame = _frames.popLatest(now);
+			break;
+		case SyncMode::FrameSync:
+			// The newest frame due at a fixed delay behind now, repeating or
+			// dropping frames as the two clocks drift, so latency stays
+			// constant whatever the cook time.
+			frame = _frames.popLatest(now - _params.syncLatency);
+			break;
+		case SyncMode::CookClock: {
+			// Cooks are released by TouchDesigner's frame clock but run late
+			// by a varying amount. Estimating when each cook should have run
+			// from the frame count removes that jitter from the selection.
+			const int64_t framePeriod = static_cast<int64_t>(10000000. / timeInfo->rootRate);
+			const int64_t idealCookTime = _cookClock.map(timeInfo->absFrame * framePeriod, now);
+			const int64_t target = idealCookTime - _params.syncLatency;
+
+			_state.cookJitter = now - idealCookTime;
+
+			// Compare with the frame already on screen, so a worse match is
+			// never shown
+			const VideoFrame * current = _nextFrame ? _nextFrame.get() : _frontFrame.get();
+			const int64_t currentTime = current ? current->presentationTime : std::numeric_limits<int64_t>::min() / 2;
+
+			frame = _frames.popNearest(target, currentTime);
+
+			const int64_t shownTime = frame ? frame->presentationTime : currentTime;
+
+			if(frame || current) {
+				_state.phaseError = shownTime - target;
+				_state.averagePhaseError += (std::abs(static_cast<double>(_state.phaseError)) - _state.averagePhaseError) * .05;
+			}
+		} break;
+	}
+
+	if(!frame) {
+		if(_params.syncMode != SyncMode::Latest && _frontFrame)
+			++_state.repeatedFrames;
+
+		return;
+	}
+
+	// A frame selected on a previous cook but never executed
+	_frames.recycle(std::move(_nextFrame));
+	_nextFrame = std::move(frame);
 }
 
 void NDIInTOP::getErrorString(OP_String * error, void *) {
@@ -324,7 +992,197 @@ void NDIInTOP::getErrorString(OP_String * error, void *) {
 }
 
 void NDIInTOP::getWarningString(OP_String * warning, void *) {
-	if(_state.warningMessage.size() != 0)
+	if(_state.recordError.size() != 0)
+		warning->setString(_state.recordError.c_str());
+	else if(_state.warningMessage.size() != 0)
 		warning->setString(_state.warningMessage.c_str());
 }
 
+
+void NDIInTOP::receiveLoop() {
+	NDIlib_video_frame_v2_t videoFrame;
+
+	while (_receiving) {
+		// The timeout bounds how long stopping the thread can take
+		if(NDIlib_recv_capture_v2(_receiver, &videoFrame, nullptr, nullptr, 100) != NDIlib_frame_type_video)
+			continue;
+
+		std::shared_ptr<RawVideoWriter> recorder;
+
+		{
+			std::unique_lock<std::mutex> recorderLock(_recorderMutex);
+			recorder = _recorder;
+		}
+
+		// Record the frame as received, before any processing
+		if(recorder)
+			recordFrame(*recorder, videoFrame);
+
+		processFrame(videoFrame);
+
+		NDIlib_recv_free_video_v2(_receiver, &videoFrame);
+	}
+}
+
+void NDIInTOP::processFrame(const NDIlib_video_frame_v2_t &videoFrame) {
+	ReceiveSettings settings;
+
+	{
+		std::unique_lock<std::mutex> settingsLock(_settingsMutex);
+		settings = _settings;
+	}
+
+	_deinterlacer.setMotionThreshold(settings.motionThreshold);
+
+	const int stride = videoFrame.line_stride_in_bytes;
+
+	// When to show the frame, on our clock
+	const int64_t arrivalTime = ClockMapper::now();
+	const int64_t presentationTime = videoFrame.timestamp == NDIlib_recv_timestamp_undefined ?
+		arrivalTime :
+		_clockMapper.map(videoFrame.timestamp, arrivalTime);
+
+	// The second field of a frame is shown half a frame later
+	const int64_t halfFrame = videoFrame.frame_rate_N > 0 ?
+		static_cast<int64_t>(5000000) * videoFrame.frame_rate_D / videoFrame.frame_rate_N :
+		0;
+
+	switch (videoFrame.frame_format_type) {
+		case NDIlib_frame_format_type_interleaved: {
+			// Both fields in one frame, the even lines being the first in time
+			_deinterlacer.pushField(videoFrame.p_data, stride * 2,
+									videoFrame.xres, videoFrame.yres / 2, 0,
+									_pool.get());
+
+			if(settings.fieldRate)
+				publishField(settings, videoFrame, presentationTime);
+
+			_deinterlacer.pushField(videoFrame.p_data + stride, stride * 2,
+									videoFrame.xres, videoFrame.yres / 2, 1,
+									_pool.get());
+
+			// Both fields are published now, the cook only shows the second
+			// once its presentation time is reached
+			publishField(settings, videoFrame, presentationTime, settings.fieldRate ? halfFrame : 0);
+		} break;
+		case NDIlib_frame_format_type_field_0:
+		case NDIlib_frame_format_type_field_1: {
+			// A single field. yres is the height of the whole frame
+			const int parity = videoFrame.frame_format_type == NDIlib_frame_format_type_field_1 ? 1 : 0;
+
+			_deinterlacer.pushField(videoFrame.p_data, stride,
+									videoFrame.xres, videoFrame.yres / 2, parity,
+									_pool.get());
+
+			// At frame rate, wait for the second field
+			if(settings.fieldRate || parity == 1)
+				publishField(settings, videoFrame, presentationTime);
+		} break;
+		default: {
+			// Progressive
+			_deinterlacer.reset();
+
+			int cropX, cropY, cropWidth, cropHeight;
+			getCropRect(settings, videoFrame.xres, videoFrame.yres, cropX, cropY, cropWidth, cropHeight);
+
+			// Read straight from the NDI buffer, only the rows and columns of the crop
+			publishFrame(settings,
+						 videoFrame.p_data + cropY * stride + cropX * 4, stride,
+						 cropWidth, cropHeight,
+						 videoFrame, 1, presentationTime);
+		} break;
+	}
+}
+
+void NDIInTOP::publishField(const ReceiveSettings &settings,
+							const NDIlib_video_frame_v2_t &videoFrame,
+							int64_t presentationTime,
+							int64_t fieldOffset) {
+	const int frameWidth = _deinterlacer.getWidth();
+	const int frameHeight = _deinterlacer.getFrameHeight();
+
+	int cropX, cropY, cropWidth, cropHeight;
+	getCropRect(settings, frameWidth, frameHeight, cropX, cropY, cropWidth, cropHeight);
+
+	// Only rebuild the rows of the crop
+	const int rowBytes = frameWidth * 4;
+	_deinterlacedRows.resize(rowBytes * cropHeight);
+
+	_deinterlacer.render(settings.deinterlaceMode,
+						 _deinterlacedRows.data(), rowBytes,
+						 cropY, cropY + cropHeight,
+						 _pool.get());
+
+	publishFrame(settings,
+				 _deinterlacedRows.data() + cropX * 4, rowBytes,
+				 cropWidth, cropHeight,
+				 videoFrame, settings.fieldRate ? 2 : 1, presentationTime, fieldOffset);
+}
+
+void NDIInTOP::publishFrame(const ReceiveSettings &settings,
+							const uint8_t * data, int stride,
+							int width, int height,
+							const NDIlib_video_frame_v2_t &videoFrame,
+							int frameRateMultiplier,
+							int64_t presentationTime,
+							int64_t fieldOffset) {
+	int outputWidth = width;
+	int outputHeight = height;
+
+	if(settings.customResolution) {
+		outputWidth = settings.width;
+		outputHeight = settings.height;
+	}
+
+	VideoScaler::fitInside(outputWidth, outputHeight, settings.maxWidth, settings.maxHeight, outputWidth, outputHeight);
+
+	// Only the output size is written
+	_scaler.configure(width, height, outputWidth, outputHeight, settings.filter);
+
+	std::unique_ptr<VideoFrame> frame = _frames.acquire();
+
+	frame->data.resize(outputWidth * outputHeight * 4);
+	_scaler.process(data, stride,
+					frame->data.data(), outputWidth * 4,
+					_pool.get());
+
+	frame->width = outputWidth;
+	frame->height = outputHeight;
+	frame->sourceWidth = videoFrame.xres;
+	frame->sourceHeight = videoFrame.yres;
+	frame->frameRateN = videoFrame.frame_rate_N * frameRateMultiplier;
+	frame->frameRateD = videoFrame.frame_rate_D;
+	frame->timestamp = videoFrame.timestamp == NDIlib_recv_timestamp_undefined ?
+		videoFrame.timestamp :
+		videoFrame.timestamp + fieldOffset;
+	frame->timecode = videoFrame.timecode + fieldOffset;
+	frame->presentationTime = presentationTime + fieldOffset;
+
+	// Measure the frame while it is still in cache
+	if(settings.analyze) {
+		_analyzer.analyze(frame->data.data(), outputWidth * 4,
+						  outputWidth, outputHeight,
+						  settings.analysis,
+						  _pool.get());
+
+		std::unique_lock<std::mutex> analysisLock(_analysisMutex);
+		_analysis = _analyzer.getResult();
+	}
+
+	// Publish
+	_frames.push(std::move(frame));
+}
+
+void NDIInTOP::getCropRect(const ReceiveSettings &settings,
+						   int sourceWidth, int sourceHeight,
+						   int &x, int &y, int &width, int &height) {
+	const int left = static_cast<int>(std::lround(settings.cropLeft * sourceWidth));
+	const int right = static_cast<int>(std::lround(settings.cropRight * sourceWidth));
+	const int top = static_cast<int>(std::lround(settings.cropTop * sourceHeight));
+	const int bottom = static_cast<int>(std::lround(settings.cropBottom * sourceHeight));
+
+	x = std::max(0, std::min(std::min(left, right), sourceWidth - 1));
+	y = std::max(0, std::min(std::min(top, bottom), sourceHeight - 1));
+	width = std::max(1, std::min(std::max(left, right), sourceWidth) - x);
+	height = std::max(1, std::min(std::max(top, bottom), sourceHeight) - y);
+}
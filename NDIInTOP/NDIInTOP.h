@@ -8,8 +8,22 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <limits>
 
 #include "../third-parties/TOP_CPlusPlusBase.h"
+#include "../Utils/video_scaler.hpp"
+#include "../Utils/deinterlacer.hpp"
+#include "../Utils/frame_queue.hpp"
+#include "../Utils/clock_mapper.hpp"
+#include "../Utils/sync_group.hpp"
+#include "../Utils/video_analyzer.hpp"
+#include "../Utils/raw_video_writer.hpp"
+#include "../Utils/source_prober.hpp"
+#include "../Utils/worker_pool.hpp"
 
 #include <Processing.NDI.Lib.h>
 
@@ -44,26 +58,242 @@ public:
 	virtual void getWarningString(OP_String *warning, void *reserved1) override;
 
 private:
+	// First, see WorkerPool::acquire()
+	std::shared_ptr<WorkerPool> _pool = WorkerPool::acquire();
+
 	// Our finder
 	NDIlib_find_instance_t _finder = nullptr;
 	NDIlib_recv_instance_t _receiver = nullptr;
-	
-	NDIlib_video_frame_v2_t _videoFrame;
+
+	// Formats of the discovered sources, for the Info DAT
+	std::shared_ptr<SourceProber> _prober;
+
+	// Frames are captured and scaled by the receive thread, then handed to
+	// the cook thread through the frames queue
+	std::thread _receiveThread;
+	std::atomic<bool> _receiving = {false};
+
+	/// Largest frames queue, for the longest sync latency at high frame
+	/// rates
+	static const size_t maxQueuedFrames = 64;
+
+	// Sized by updateQueueCapacity() following the sync mode
+	FrameQueue _frames = FrameQueue(maxQueuedFrames);
+	std::unique_ptr<VideoFrame> _nextFrame;   // Selected for this cook
+	std::unique_ptr<VideoFrame> _frontFrame;  // Last one given to TouchDesigner
+
+	// Shared with the other receivers of the sync group, if any
+	std::shared_ptr<SyncGroup> _syncGroup;
+
+	ClockMapper _clockMapper;  // Receive thread
+	ClockMapper _cookClock;    // Cook thread, ideal cook times from TouchDesigner's frame count
+
+	VideoScaler _scaler;          // Receive thread
+	VideoScaler _fallbackScaler;  // Cook thread
+
+	Deinterlacer _deinterlacer;             // Receive thread
+	std::vector<uint8_t> _deinterlacedRows;  // Receive thread
+
+	VideoAnalyzer _analyzer;  // Receive thread
+
+	// Streams the received frames to disk while recording. The receive
+	// thread keeps its own reference so closing never races a push.
+	std::shared_ptr<RawVideoWriter> _recorder;
+	std::mutex _recorderMutex;
+
+	// Recordings being closed in the background, by file. Flushing the
+	// queue and writing the index must not stall the cook.
+	std::vector<std::pair<std::string, std::future<void>>> _closingRecorders;
+
+	// Result of the last analyzed frame, written by the receive thread
+	VideoAnalyzer::Result _analysis;
+	std::mutex _analysisMutex;
+
+	enum class SyncMode {
+		/// Show the latest received frame
+		Latest,
+
+		/// Show the newest frame due at a fixed delay behind the cook
+		FrameSync,
+
+		/// Show the frame whose presentation time best matches the ideal
+		/// time of the cook, at a fixed delay
+		CookClock
+	};
 
 	struct {
 		bool active = true;
 		std::string sourceName = "";
 		NDIlib_recv_bandwidth_e bandwidth;
 		char additionalIPs[256] = {'\0'};
+		bool deinterlace = false;
+
+		// Present frames following their timestamps, this long after they
+		// were sent (100 ns units)
+		SyncMode syncMode = SyncMode::Latest;
+		int64_t syncLatency = 500000;
+
+		// Show frames together with the other receivers of the group,
+		// matching their timestamps or timecodes
+		std::string syncGroup = "";
+		bool syncOnTimecode = false;
+		int64_t syncTolerance = 20000;
+
+		bool record = false;
+		std::string recordFile = "";
+		int recordQueue = 16;
 	} _params;
 
+	/// Parameters read by the receive thread, guarded by the settings mutex
+	struct ReceiveSettings {
+		bool customResolution = false;
+		int width = 1920;
+		int height = 1080;
+		VideoScaler::Filter filter = VideoScaler::Filter::Box;
+
+		// Region of the source to keep, as fractions of its size, from the
+		// top-left corner of the picture
+		double cropLeft = 0;
+		double cropRight = 1;
+		double cropTop = 0;
+		double cropBottom = 1;
+
+		Deinterlacer::Mode deinterlaceMode = Deinterlacer::Mode::MotionAdaptive;
+		bool fieldRate = false;
+		uint8_t motionThreshold = 12;
+
+		// Measure the published frames
+		bool analyze = false;
+		VideoAnalyzer::Settings analysis;
+
+		// Largest buffers TouchDesigner gave us, lowered when the licence
+		// limits the output resolution
+		int maxWidth = std::numeric_limits<int>::max();
+		int maxHeight = std::numeric_limits<int>::max();
+	};
+
+	ReceiveSettings _settings;
+
+	std::mutex _settingsMutex;
+
 	struct {
 		uint32_t sourcesCount = 0;
 		std::vector<std::string> sourcesNames;
 		std::vector<std::string> sourcesAdresses;
 
+		// Size requested for the frame of this cook
+		int outputWidth = 0;
+		int outputHeight = 0;
+
+		// Cooks where frame sync had no new frame to show
+		uint64_t repeatedFrames = 0;
+
+		// Cook clock alignment, in 100 ns units
+		int64_t phaseError = 0;        // Selected frame minus target time
+		double averagePhaseError = 0;  // Smoothed absolute phase error
+		int64_t cookJitter = 0;        // Actual minus ideal cook time
+
+		// Copy of the latest analysis, for the Info CHOP
+		VideoAnalyzer::Result analysis;
+
 		bool isErrored = false;
 		std::string errorMessage;
 		std::string warningMessage;
+		std::string recordFile;   // File being recorded
+		std::string recordError;
 	} _state;
+
+	/// Starts the receive thread on the current receiver
+	/// Does nothing if the thread is already running
+	inline void startReceiving() {
+		if(_receiveThread.joinable())
+			return;
+
+		_receiving = true;
+		_receiveThread = std::thread(&NDIInTOP::receiveLoop, this);
+	}
+
+	/// Stops the receive thread and closes the current connection
+	inline void stopReceiving() {
+		_receiving = false;
+
+		if(_receiveThread.joinable())
+			_receiveThread.join();
+
+		NDIlib_recv_destroy(_receiver);
+		_receiver = nullptr;
+
+		_frames.clear();
+		_frames.recycle(std::move(_nextFrame));
+		_analyzer.reset();
+		_clockMapper.reset();
+		_cookClock.reset();
+
+		std::unique_lock<std::mutex> analysisLock(_analysisMutex);
+		_analysis = VideoAnalyzer::Result();
+	}
+
+	/// Leaves the current sync group and joins the given one. Does nothing if
+	/// already in it.
+	/// @param name The group name, empty to leave groups
+	void setSyncGroup(const std::string &name);
+
+	/// Starts or stops recording following the parameters
+	void updateRecorder();
+
+	/// Closes the recorder on a background thread
+	/// @param file The file it writes, not opened again until it is closed
+	void closeRecorder(std::shared_ptr<RawVideoWriter> recorder, const std::string &file);
+
+	/// Forgets the recorders done closing
+	/// @returns True if the given file is still being closed
+	bool isRecorderClosing(const std::string &file);
+
+	/// Queues a received frame, as sent, for the recorder
+	static void recordFrame(RawVideoWriter &recorder, const NDIlib_video_frame_v2_t &videoFrame);
+
+	/// Sizes the frames queue for the sync mode: a few frames when showing
+	/// the latest one, the sync latency worth of frames otherwise
+	void updateQueueCapacity();
+
+	/// Takes the frame to show on this cook out of the queue
+	void selectFrame(const OP_TimeInfo * timeInfo);
+
+	/// Continuously captures video frames from the receiver
+	void receiveLoop();
+
+	/// Sends a received frame through the deinterlacer if it holds fields,
+	/// and publishes the resulting progressive frames
+	void processFrame(const NDIlib_video_frame_v2_t &videoFrame);
+
+	/// Renders the frame rebuilt around the latest field and publishes it
+	/// @param fieldOffset Time of the field from the start of the NDI frame,
+	/// in 100 ns units
+	void publishField(const ReceiveSettings &settings,
+					  const NDIlib_video_frame_v2_t &videoFrame,
+					  int64_t presentationTime,
+					  int64_t fieldOffset = 0);
+
+	/// Scales the cropped part of a progressive frame to the output size and
+	/// publishes it to the cook thread
+	/// @param data First pixel of the crop
+	/// @param stride Size in bytes of a row of data
+	/// @param frameRateMultiplier 2 when publishing at field rate
+	/// @param presentationTime When to show the NDI frame, on the local clock
+	/// @param fieldOffset Added to the presentation time, timestamp and
+	/// timecode of the NDI frame, so the two fields of an interleaved frame
+	/// each have their own time
+	void publishFrame(const ReceiveSettings &settings,
+					  const uint8_t * data, int stride,
+					  int width, int height,
+					  const NDIlib_video_frame_v2_t &videoFrame,
+					  int frameRateMultiplier,
+					  int64_t presentationTime,
+					  int64_t fieldOffset = 0);
+
+	/// Computes the crop rectangle in pixels for the given source size, at
+	/// least one pixel wide and high
+	static void getCropRect(const ReceiveSettings &settings,
+							int sourceWidth, int sourceHeight,
+							int &x, int &y, int &width, int &height);
 };
@@ -0,0 +1,708 @@
+//
+//  NDIMultiviewTOP.cpp
+//  NDIMultiviewTOP
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "NDIMultiviewTOP.h"
+
+#include "../Utils/fast_memcpy.h"
+#include "../Utils/worker_pool.hpp"
+#include "../Utils/clock_mapper.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+// Colors of the canvas, as little-endian BGRA
+static const uint32_t backgroundColor = 0xFF000000;
+static const uint32_t searchingColor = 0xFF282828;
+static const uint32_t connectingColor = 0xFF404040;
+static const uint32_t noSignalColor = 0xFF102040;
+static const uint32_t failedColor = 0xFF600000;
+
+// Wait this long before trying to connect again to a failed source, in 100 ns units
+static const int64_t retryDelay = 20000000;
+
+NDIMultiviewTOP::NDIMultiviewTOP(const OP_NodeInfo *) {
+	if(!NDIlib_initialize()) {
+		_state.isErrored = true;
+		_state.errorMessage = "Could not initialized NDI. CPU may be unsupported.";
+		return;
+	}
+}
+
+NDIMultiviewTOP::~NDIMultiviewTOP() {
+	for(std::unique_ptr<Tile> &tile: _tiles)
+		stopReceiving(*tile);
+
+	NDIlib_find_destroy(_finder);
+	NDIlib_destroy();
+}
+
+void NDIMultiviewTOP::getGeneralInfo(TOP_GeneralInfo * ginfo,
+									 const OP_Inputs * inputs,
+									 void *) {
+	try {
+		ginfo->cookEveryFrameIfAsked = true;
+		ginfo->memPixelType = OP_CPUMemPixelType::BGRA8Fixed;
+		ginfo->clearBuffers = false;
+
+		// get parameters
+		_params.active = inputs->getParInt("Active");
+
+		if (!_params.active) {
+			for(std::unique_ptr<Tile> &tile: _tiles)
+				stopReceiving(*tile);
+
+			if (_finder != nullptr) {
+				NDIlib_find_destroy(_finder);
+				_finder = nullptr;
+			}
+
+			return;
+		}
+
+		inputs->getParInt2("Resolution", _params.width, _params.height);
+		_params.columns = inputs->getParInt("Columns");
+		_params.spacing = inputs->getParInt("Spacing");
+		_params.filter = std::string(inputs->getParString("Scalefilter")) == "Bilinear" ?
+			VideoScaler::Filter::Bilinear :
+			VideoScaler::Filter::Box;
+		_params.noSignalTimeout = static_cast<int64_t>(inputs->getParDouble("Nosignaltimeout") * 10000000.);
+
+		// Bandwidth
+		const NDIlib_recv_bandwidth_e bandwidthPar = std::string(inputs->getParString("Bandwidth")) == "High" ?
+			NDIlib_recv_bandwidth_highest :
+			NDIlib_recv_bandwidth_lowest;
+
+		// Every receiver must reconnect with the new bandwidth
+		if (bandwidthPar != _params.bandwidth) {
+			for(std::unique_ptr<Tile> &tile: _tiles)
+				stopReceiving(*tile);
+		}
+
+		_params.bandwidth = bandwidthPar;
+
+		// Check if specified addition lookup ips changed
+		char additionalIPsPar[256];
+
+#ifdef _WIN32
+		strncpy_s(additionalIPsPar, 256, inputs->getParString("Additionalips"), 256);
+#else
+		strncpy(additionalIPsPar, inputs->getParString("Additionalips"), 256);
+#endif
+
+		if (strcmp(_params.additionalIPs, additionalIPsPar) != 0) {
+			// Specified IP changed, close finder
+			if (_finder != nullptr) {
+				NDIlib_find_destroy(_finder);
+				_finder = nullptr;
+			}
+
+#ifdef _WIN32
+			strcpy_s(_params.additionalIPs, 256, additionalIPsPar);
+#else
+			strlcpy(_params.additionalIPs, additionalIPsPar, 256);
+#endif
+		}
+
+		// Do we have a finder ?
+		if (_finder == nullptr) {
+			NDIlib_find_create_t finderParams;
+			finderParams.p_extra_ips = _params.additionalIPs;
+			_finder = NDIlib_find_create_v2(&finderParams);
+		}
+
+		// One tile per non-empty cell of the sources DAT
+		_params.sourcesNames.clear();
+		const OP_DATInput * sourcesDAT = inputs->getParDAT("Sourcesdat");
+
+		if(sourcesDAT != nullptr && sourcesDAT->isTable) {
+			for(int i = 0; i < sourcesDAT->numRows; ++i) {
+				for(int j = 0; j < sourcesDAT->numCols; ++j) {
+					if(strlen(sourcesDAT->getCell(i, j)) != 0)
+						_params.sourcesNames.push_back(sourcesDAT->getCell(i, j));
+				}
+			}
+		}
+
+		updateTiles();
+
+		// Check available sources
+		const NDIlib_source_t* sources = NDIlib_find_get_current_sources(_finder, &_state.sourcesCount);
+		connectTiles(sources, _state.sourcesCount);
+
+		// Missing sources only degrade their own tile
+		const size_t searchingTiles = _tiles.size() - _state.connectedTiles - _state.failedTiles;
+
+		if(_state.failedTiles > 0)
+			_state.warningMessage = "Could not connect to " + std::to_string(_state.failedTiles) + " source(s).";
+		else if(searchingTiles > 0)
+			_state.warningMessage = "Looking for " + std::to_string(searchingTiles) + " source(s)...";
+		else
+			_state.warningMessage = "";
+
+		_state.isErrored = false;
+	} catch (std::runtime_error &exc) {
+		_state.isErrored = true;
+		_state.errorMessage = "An error occured with NDI : " + std::string(exc.what());
+
+		ginfo->clearBuffers = true;
+	}
+}
+
+bool NDIMultiviewTOP::getOutputFormat(TOP_OutputFormat * format,
+									  const OP_Inputs *, void *) {
+	// Are we able to output something ?
+	if(_state.isErrored || !_params.active) {
+		return false;
+	}
+
+	// Yes, set parameters to 8bits RGBA
+	format->redChannel = true;
+	format->greenChannel = true;
+	format->blueChannel = true;
+	format->alphaChannel = true;
+	format->bitsPerChannel = 8;
+	format->width = _params.width;
+	format->height = _params.height;
+
+	return true;
+}
+
+void NDIMultiviewTOP::execute(TOP_OutputFormatSpecs * output,
+							  const OP_Inputs *, TOP_Context *, void *) {
+	// Default output is the first provided buffer
+	output->newCPUPixelDataLocation = 0;
+
+	if(_state.isErrored || !_params.active) {
+		memset(output->cpuPixelData[0], 0, output->width * output->height * 4);
+		return;
+	}
+
+	// Buffers may be smaller than requested under licence limitations, the
+	// grid always fills what we are given
+	updateLayout(output->width, output->height);
+
+	// Tiles are independent, draw them in parallel
+	std::atomic<bool> tilesChanged = {false};
+
+	_pool->parallelFor(_layout.tilesCount, [&](int begin, int end) {
+		for(int i = begin; i < end; ++i) {
+			if(drawTile(i))
+				tilesChanged = true;
+		}
+	}, 1);
+
+	// Nothing new to show, keep the previous texture
+	if(!tilesChanged && !_canvasChanged) {
+		output->newCPUPixelDataLocation = -1;
+		return;
+	}
+
+	memcpy_fast(output->cpuPixelData[0], _canvas.data(), _canvas.size());
+	_canvasChanged = false;
+}
+
+int32_t NDIMultiviewTOP::getNumInfoCHOPChans(void *) {
+	// We return the number of channel we want to output to any Info CHOP
+	// connected, num_sources
+	return 4;
+}
+
+void NDIMultiviewTOP::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan * chan, void *) {
+	switch (index) {
+		case 0:  // num_sources
+			chan->name->setString("num_sources");
+			chan->value = static_cast<float>(_state.sourcesCount);
+			break;
+		case 1:  // tiles
+			chan->name->setString("tiles");
+			chan->value = static_cast<float>(_tiles.size());
+			break;
+		case 2:  // tiles_connected
+			chan->name->setString("tiles_connected");
+			chan->value = static_cast<float>(_state.connectedTiles);
+			break;
+		case 3:  // tiles_failed
+			chan->name->setString("tiles_failed");
+			chan->value = static_cast<float>(_state.failedTiles);
+			break;
+	}
+}
+
+bool NDIMultiviewTOP::getInfoDATSize(OP_InfoDATSize * infoSize, void *) {
+	infoSize->rows = static_cast<int32_t>(_tiles.size()) + 1;
+	infoSize->cols = 4;
+	// Setting this to false means we'll be assigning values to the table
+	// one row at a time. True means we'll do it one column at a time.
+	infoSize->byColumn = false;
+	return true;
+}
+
+void NDIMultiviewTOP::getInfoDATEntries(int32_t index, int32_t,
+										OP_InfoDATEntries * entries, void *) {
+	if(index == 0) {
+		entries->values[0]->setString("Source");
+		entries->values[1]->setString("Status");
+		entries->values[2]->setString("Resolution");
+		entries->values[3]->setString("FPS");
+		return;
+	}
+
+	Tile &tile = *_tiles[index - 1];
+
+	const char * status = "";
+
+	switch (tile.status) {
+		case TileStatus::Searching: status = "Searching"; break;
+		case TileStatus::Failed: status = "Failed"; break;
+		case TileStatus::Connecting: status = "Connecting"; break;
+		case TileStatus::Receiving: status = "Receiving"; break;
+		case TileStatus::NoSignal: status = "No Signal"; break;
+	}
+
+	std::string resolution;
+	std::string fps;
+
+	{
+		std::unique_lock<std::mutex> tileLock(tile.mutex);
+
+		if(tile.sourceWidth > 0)
+			resolution = std::to_string(tile.sourceWidth) + "x" + std::to_string(tile.sourceHeight);
+
+		if(tile.frameRateD > 0 && tile.frameRateN > 0)
+			fps = std::to_string(static_cast<double>(tile.frameRateN) / tile.frameRateD);
+	}
+
+	entries->values[0]->setString(tile.sourceName.c_str());
+	entries->values[1]->setString(status);
+	entries->values[2]->setString(resolution.c_str());
+	entries->values[3]->setString(fps.c_str());
+}
+
+
+// Override these methods if you want to define specfic parameters
+void NDIMultiviewTOP::setupParameters(OP_ParameterManager * manager, void *) {
+	OP_NumericParameter activeToggle;
+	activeToggle.name = "Active";
+	activeToggle.label = "Active";
+	activeToggle.page = "NDI Multiview";
+	activeToggle.defaultValues[0] = 1;
+	manager->appendToggle(activeToggle);
+
+	OP_StringParameter sourcesDAT;
+	sourcesDAT.name = "Sourcesdat";
+	sourcesDAT.label = "Sources Table DAT";
+	sourcesDAT.page = "NDI Multiview";
+	manager->appendDAT(sourcesDAT);
+
+	OP_StringParameter additionalIPs;
+	additionalIPs.name = "Additionalips";
+	additionalIPs.label = "Additional Search IPs";
+	additionalIPs.defaultValue = "";
+	additionalIPs.page = "NDI Multiview";
+	manager->appendString(additionalIPs);
+
+	OP_StringParameter bandwidth;
+	bandwidth.name = "Bandwidth";
+	bandwidth.label = "Bandwidth";
+	bandwidth.page = "NDI Multiview";
+	bandwidth.defaultValue = "Low";
+	const char * bandwidthValues[] = {"High", "Low"};
+	manager->appendMenu(bandwidth, 2, bandwidthValues, bandwidthValues);
+
+	OP_NumericParameter resolution;
+	resolution.name = "Resolution";
+	resolution.label = "Resolution";
+	resolution.page = "NDI Multiview";
+	resolution.defaultValues[0] = 1920;
+	resolution.defaultValues[1] = 1080;
+
+	for(int i = 0; i < 2; ++i) {
+		resolution.minValues[i] = 1;
+		resolution.clampMins[i] = true;
+		resolution.minSliders[i] = 1;
+		resolution.maxSliders[i] = 4096;
+	}
+
+	manager->appendInt(resolution, 2);
+
+	OP_NumericParameter columns;
+	columns.name = "Columns";
+	columns.label = "Columns (0 = Auto)";
+	columns.page = "NDI Multiview";
+	columns.defaultValues[0] = 0;
+	columns.minValues[0] = 0;
+	columns.clampMins[0] = true;
+	columns.minSliders[0] = 0;
+	columns.maxSliders[0] = 8;
+	manager->appendInt(columns);
+
+	OP_NumericParameter spacing;
+	spacing.name = "Spacing";
+	spacing.label = "Spacing";
+	spacing.page = "NDI Multiview";
+	spacing.defaultValues[0] = 4;
+	spacing.minValues[0] = 0;
+	spacing.clampMins[0] = true;
+	spacing.minSliders[0] = 0;
+	spacing.maxSliders[0] = 32;
+	manager->appendInt(spacing);
+
+	OP_StringParameter scaleFilter;
+	scaleFilter.name = "Scalefilter";
+	scaleFilter.label = "Scale Filter";
+	scaleFilter.page = "NDI Multiview";
+	const char * scaleFilterValues[] = {"Box", "Bilinear"};
+	manager->appendMenu(scaleFilter, 2, scaleFilterValues, scaleFilterValues);
+
+	OP_NumericParameter noSignalTimeout;
+	noSignalTimeout.name = "Nosignaltimeout";
+	noSignalTimeout.label = "No Signal Timeout (s)";
+	noSignalTimeout.page = "NDI Multiview";
+	noSignalTimeout.defaultValues[0] = 2;
+	noSignalTimeout.minValues[0] = 0.1;
+	noSignalTimeout.clampMins[0] = true;
+	noSignalTimeout.minSliders[0] = 0.1;
+	noSignalTimeout.maxSliders[0] = 10;
+	manager->appendFloat(noSignalTimeout);
+}
+
+void NDIMultiviewTOP::getErrorString(OP_String * error, void *) {
+	if(_state.isErrored)
+		error->setString(_state.errorMessage.c_str());
+}
+
+void NDIMultiviewTOP::getWarningString(OP_String * warning, void *) {
+	if(_state.warningMessage.size() != 0)
+		warning->setString(_state.warningMessage.c_str());
+}
+
+void NDIMultiviewTOP::updateTiles() {
+	const size_t tilesCount = _params.sourcesNames.size();
+
+	// Tiles whose source moved or disappeared are closed
+	for(size_t i = 0; i < _tiles.size(); ++i) {
+		if(i < tilesCount && _tiles[i]->sourceName == _params.sourcesNames[i])
+			continue;
+
+		stopReceiving(*_tiles[i]);
+	}
+
+	if(_tiles.size() > tilesCount)
+		_tiles.resize(tilesCount);
+
+	while(_tiles.size() < tilesCount)
+		_tiles.emplace_back(new Tile());
+
+	for(size_t i = 0; i < tilesCount; ++i) {
+		Tile &tile = *_tiles[i];
+
+		if(tile.sourceName == _params.sourcesNames[i])
+			continue;
+
+		tile.sourceName = _params.sourcesNames[i];
+		tile.status = TileStatus::Searching;
+		tile.retryTime = 0;
+		tile.needsRedraw = true;
+
+		std::unique_lock<std::mutex> tileLock(tile.mutex);
+		tile.width = 0;
+		tile.height = 0;
+		tile.hasNewImage = false;
+		tile.sourceWidth = 0;
+		tile.sourceHeight = 0;
+		tile.frameRateN = 0;
+		tile.frameRateD = 1;
+		tile.lastFrameTime = 0;
+	}
+}
+
+void NDIMultiviewTOP::connectTiles(const NDIlib_source_t * sources, uint32_t sourcesCount) {
+	const int64_t now = ClockMapper::now();
+
+	_state.connectedTiles = 0;
+	_state.failedTiles = 0;
+
+	for(std::unique_ptr<Tile> &tilePtr: _tiles) {
+		Tile &tile = *tilePtr;
+
+		if(tile.receiver == nullptr) {
+			if(tile.status == TileStatus::Failed && now < tile.retryTime) {
+				++_state.failedTiles;
+				continue;
+			}
+
+			tile.status = TileStatus::Searching;
+
+			for (uint32_t i = 0; i < sourcesCount; ++i) {
+				if (tile.sourceName != sources[i].p_ndi_name)
+					continue;
+
+				// Connect to the source
+				NDIlib_recv_create_v3_t receiverOptions;
+				receiverOptions.color_format = NDIlib_recv_color_format_BGRX_BGRA;
+				receiverOptions.allow_video_fields = false;
+				receiverOptions.bandwidth = _params.bandwidth;
+				receiverOptions.source_to_connect_to = sources[i];
+
+				tile.receiver = NDIlib_recv_create_v3(&receiverOptions);
+
+				if (!tile.receiver) {
+					// Only this tile is affected, try again later
+					tile.status = TileStatus::Failed;
+					tile.retryTime = now + retryDelay;
+					break;
+				}
+
+				tile.status = TileStatus::Connecting;
+				startReceiving(tile);
+				break;
+			}
+
+			if(tile.status == TileStatus::Failed)
+				++_state.failedTiles;
+			else if(tile.status == TileStatus::Connecting)
+				++_state.connectedTiles;
+
+			continue;
+		}
+
+		// Connected, check frames are still arriving
+		int64_t lastFrameTime;
+
+		{
+			std::unique_lock<std::mutex> tileLock(tile.mutex);
+			lastFrameTime = tile.lastFrameTime;
+		}
+
+		if(lastFrameTime == 0)
+			tile.status = TileStatus::Connecting;
+		else if(now - lastFrameTime > _params.noSignalTimeout)
+			tile.status = TileStatus::NoSignal;
+		else
+			tile.status = TileStatus::Receiving;
+
+		++_state.connectedTiles;
+	}
+}
+
+void NDIMultiviewTOP::startReceiving(Tile &tile) {
+	if(tile.receiveThread.joinable())
+		return;
+
+	tile.receiving = true;
+	tile.receiveThread = std::thread(&NDIMultiviewTOP::receiveLoop, this, &tile);
+}
+
+void NDIMultiviewTOP::stopReceiving(Tile &tile) {
+	tile.receiving = false;
+
+	if(tile.receiveThread.joinable())
+		tile.receiveThread.join();
+
+	NDIlib_recv_destroy(tile.receiver);
+	tile.receiver = nullptr;
+	tile.status = TileStatus::Searching;
+	tile.retryTime = 0;
+
+	std::unique_lock<std::mutex> tileLock(tile.mutex);
+	tile.hasNewImage = false;
+	tile.lastFrameTime = 0;
+}
+
+void NDIMultiviewTOP::receiveLoop(Tile * tile) {
+	NDIlib_video_frame_v2_t videoFrame;
+
+	while (tile->receiving) {
+		// The timeout bounds how long stopping the thread can take
+		if(NDIlib_recv_capture_v2(tile->receiver, &videoFrame, nullptr, nullptr, 100) != NDIlib_frame_type_video)
+			continue;
+
+		int maxWidth, maxHeight;
+		VideoScaler::Filter filter;
+
+		{
+			std::unique_lock<std::mutex> tileLock(tile->mutex);
+			maxWidth = tile->maxWidth;
+			maxHeight = tile->maxHeight;
+			filter = tile->filter;
+		}
+
+		// Scale outside the lock, the cook thread only waits for the swap
+		int width = 0;
+		int height = 0;
+
+		if(maxWidth > 0 && maxHeight > 0) {
+			VideoScaler::fitInside(videoFrame.xres, videoFrame.yres, maxWidth, maxHeight, width, height);
+
+			tile->scaler.configure(videoFrame.xres, videoFrame.yres, width, height, filter);
+			tile->backImage.resize(width * height * 4);
+			tile->scaler.process(videoFrame.p_data, videoFrame.line_stride_in_bytes,
+								 tile->backImage.data(), width * 4,
+								 _pool.get());
+		}
+
+		{
+			std::unique_lock<std::mutex> tileLock(tile->mutex);
+
+			if(width > 0) {
+				tile->image.swap(tile->backImage);
+				tile->width = width;
+				tile->height = height;
+				tile->hasNewImage = true;
+			}
+
+			tile->sourceWidth = videoFrame.xres;
+			tile->sourceHeight = videoFrame.yres;
+			tile->frameRateN = videoFrame.frame_rate_N;
+			tile->frameRateD = videoFrame.frame_rate_D;
+			tile->lastFrameTime = ClockMapper::now();
+		}
+
+		NDIlib_recv_free_video_v2(tile->receiver, &videoFrame);
+	}
+}
+
+void NDIMultiviewTOP::updateLayout(int width, int height) {
+	const int tilesCount = static_cast<int>(_tiles.size());
+
+	int columns = _params.columns > 0 ?
+		std::min(_params.columns, std::max(tilesCount, 1)) :
+		static_cast<int>(std::ceil(std::sqrt(static_cast<double>(tilesCount))));
+	columns = std::max(columns, 1);
+
+	const int rows = std::max((tilesCount + columns - 1) / columns, 1);
+
+	if(_layout.width == width &&
+	   _layout.height == height &&
+	   _layout.columns == columns &&
+	   _layout.rows == rows &&
+	   _layout.spacing == _params.spacing &&
+	   _layout.tilesCount == tilesCount &&
+	   _layout.filter == _params.filter)
+		return;
+
+	_layout.width = width;
+	_layout.height = height;
+	_layout.columns = columns;
+	_layout.rows = rows;
+	_layout.spacing = _params.spacing;
+	_layout.tilesCount = tilesCount;
+	_layout.filter = _params.filter;
+
+	_canvas.resize(width * height * 4);
+	fillRect(0, 0, width, height, backgroundColor);
+	_canvasChanged = true;
+
+	// Receive threads scale the next frames to the new areas
+	for(int i = 0; i < tilesCount; ++i) {
+		Tile &tile = *_tiles[i];
+
+		int x, y, tileWidth, tileHeight;
+		getTileRect(i, x, y, tileWidth, tileHeight);
+
+		std::unique_lock<std::mutex> tileLock(tile.mutex);
+		tile.maxWidth = tileWidth;
+		tile.maxHeight = tileHeight;
+		tile.filter = _layout.filter;
+		tile.needsRedraw = true;
+	}
+}
+
+void NDIMultiviewTOP::getTileRect(int index, int &x, int &y, int &width, int &height) const {
+	const int column = index % _layout.columns;
+	const int row = index / _layout.columns;
+
+	const int left = column * _layout.width / _layout.columns;
+	const int right = (column + 1) * _layout.width / _layout.columns;
+	const int top = row * _layout.height / _layout.rows;
+	const int bottom = (row + 1) * _layout.height / _layout.rows;
+
+	// Half the spacing on each side of the cell
+	const int inset = std::min(_layout.spacing / 2, std::min(right - left, bottom - top) / 2);
+
+	x = left + inset;
+	y = top + inset;
+	width = std::max(right - left - inset * 2, 1);
+	height = std::max(bottom - top - inset * 2, 1);
+}
+
+bool NDIMultiviewTOP::drawTile(int index) {
+	Tile &tile = *_tiles[index];
+
+	int x, y, width, height;
+	getTileRect(index, x, y, width, height);
+
+	std::unique_lock<std::mutex> tileLock(tile.mutex);
+
+	// Frames scaled for a previous layout wait for the next one
+	const bool imageFits = tile.width > 0 && tile.width <= width && tile.height <= height;
+
+	TileStatus shownStatus = tile.status;
+
+	if(shownStatus == TileStatus::Receiving && !imageFits)
+		shownStatus = TileStatus::Connecting;
+
+	if(shownStatus != TileStatus::Receiving) {
+		if(!tile.needsRedraw && tile.drawnStatus == shownStatus)
+			return false;
+
+		uint32_t color = searchingColor;
+
+		switch (shownStatus) {
+			case TileStatus::Failed: color = failedColor; break;
+			case TileStatus::Connecting: color = connectingColor; break;
+			case TileStatus::NoSignal: color = noSignalColor; break;
+			default: break;
+		}
+
+		fillRect(x, y, width, height, color);
+
+		tile.drawnStatus = shownStatus;
+		tile.drawnWidth = 0;
+		tile.drawnHeight = 0;
+		tile.needsRedraw = false;
+		return true;
+	}
+
+	if(!tile.hasNewImage && !tile.needsRedraw && tile.drawnStatus == TileStatus::Receiving)
+		return false;
+
+	// Letterbox around the image when its size changes
+	if(tile.needsRedraw ||
+	   tile.drawnStatus != TileStatus::Receiving ||
+	   tile.drawnWidth != tile.width ||
+	   tile.drawnHeight != tile.height)
+		fillRect(x, y, width, height, backgroundColor);
+
+	// Centered in the tile
+	const int imageX = x + (width - tile.width) / 2;
+	const int imageY = y + (height - tile.height) / 2;
+	const int rowBytes = tile.width * 4;
+
+	for(int row = 0; row < tile.height; ++row) {
+		memcpy_fast(_canvas.data() + ((imageY + row) * _layout.width + imageX) * 4,
+					tile.image.data() + row * rowBytes,
+					rowBytes);
+	}
+
+	tile.hasNewImage = false;
+	tile.drawnStatus = TileStatus::Receiving;
+	tile.drawnWidth = tile.width;
+	tile.drawnHeight = tile.height;
+	tile.needsRedraw = false;
+	return true;
+}
+
+void NDIMultiviewTOP::fillRect(int x, int y, int width, int height, uint32_t color) {
+	for(int row = y; row < y + height; ++row) {
+		uint32_t * pixels = reinterpret_cast<uint32_t *>(_canvas.data()) + row * _layout.width + x;
+		std::fill(pixels, pixels + width, color);
+	}
+}
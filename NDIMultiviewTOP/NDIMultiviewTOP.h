@@ -0,0 +1,184 @@
+//
+//  NDIMultiviewTOP.h
+//  NDIMultiviewTOP
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "../third-parties/TOP_CPlusPlusBase.h"
+#include "../Utils/video_scaler.hpp"
+#include "../Utils/worker_pool.hpp"
+
+#include <Processing.NDI.Lib.h>
+
+/// Receives multiple sources and composites them into a single grid. Each
+/// tile has its own receiver and receive thread, scaling frames down to the
+/// tile size as they arrive. Cooks only copy the tiles that changed into a
+/// canvas, which is uploaded as one texture.
+class NDIMultiviewTOP : public TOP_CPlusPlusBase
+{
+public:
+	NDIMultiviewTOP(const OP_NodeInfo *info);
+	virtual ~NDIMultiviewTOP();
+
+	virtual void getGeneralInfo(TOP_GeneralInfo *, const OP_Inputs*, void*) override;
+	virtual bool getOutputFormat(TOP_OutputFormat*, const OP_Inputs*, void*) override;
+
+
+	virtual void execute(TOP_OutputFormatSpecs*,
+							const OP_Inputs*,
+							TOP_Context* context,
+							void* reserved1) override;
+
+	virtual int32_t getNumInfoCHOPChans(void *reserved1) override;
+	virtual void getInfoCHOPChan(int32_t index,
+								OP_InfoCHOPChan *chan, void* reserved1) override;
+
+	virtual bool getInfoDATSize(OP_InfoDATSize *infoSize, void *reserved1) override;
+	virtual void getInfoDATEntries(int32_t index,
+									int32_t nEntries,
+									OP_InfoDATEntries *entries,
+									void *reserved1) override;
+
+	virtual void setupParameters(OP_ParameterManager *manager, void *reserved1) override;
+
+	virtual void getErrorString(OP_String *error, void *reserved1) override;
+	virtual void getWarningString(OP_String *warning, void *reserved1) override;
+
+private:
+	// First, see WorkerPool::acquire()
+	std::shared_ptr<WorkerPool> _pool = WorkerPool::acquire();
+
+	enum class TileStatus {
+		/// The source is not on the network
+		Searching,
+
+		/// A receiver could not be created for the source
+		Failed,
+
+		/// Connected, but no frame received yet
+		Connecting,
+
+		/// Connected, frames are arriving
+		Receiving,
+
+		/// Connected, but no frame arrived for a while
+		NoSignal
+	};
+
+	struct Tile {
+		std::string sourceName;
+		NDIlib_recv_instance_t receiver = nullptr;
+
+		std::thread receiveThread;
+		std::atomic<bool> receiving = {false};
+
+		VideoScaler scaler;              // Receive thread
+		std::vector<uint8_t> backImage;  // Receive thread
+
+		// Shared with the receive thread
+		std::mutex mutex;
+		int maxWidth = 0;    // Size of the tile area
+		int maxHeight = 0;
+		VideoScaler::Filter filter = VideoScaler::Filter::Box;
+		std::vector<uint8_t> image;  // Latest scaled frame
+		int width = 0;
+		int height = 0;
+		bool hasNewImage = false;
+		int sourceWidth = 0;
+		int sourceHeight = 0;
+		int frameRateN = 0;
+		int frameRateD = 1;
+		int64_t lastFrameTime = 0;  // ClockMapper::now() units
+
+		// Cook thread
+		TileStatus status = TileStatus::Searching;
+		TileStatus drawnStatus = TileStatus::Searching;
+		int drawnWidth = 0;
+		int drawnHeight = 0;
+		bool needsRedraw = true;
+		int64_t retryTime = 0;  // When to try connecting again after a failure
+	};
+
+	// Our finder
+	NDIlib_find_instance_t _finder = nullptr;
+
+	std::vector<std::unique_ptr<Tile>> _tiles;
+
+	// The grid, copied as a whole to TouchDesigner's buffer
+	std::vector<uint8_t> _canvas;
+	bool _canvasChanged = true;
+
+	struct {
+		bool active = true;
+		std::vector<std::string> sourcesNames;
+		NDIlib_recv_bandwidth_e bandwidth = NDIlib_recv_bandwidth_lowest;
+		char additionalIPs[256] = {'\0'};
+		int width = 1920;
+		int height = 1080;
+		int columns = 0;
+		int spacing = 4;
+		VideoScaler::Filter filter = VideoScaler::Filter::Box;
+		int64_t noSignalTimeout = 20000000;  // 100 ns units
+	} _params;
+
+	// Grid the canvas is currently drawn with
+	struct {
+		int width = 0;
+		int height = 0;
+		int columns = 0;
+		int rows = 0;
+		int spacing = 0;
+		int tilesCount = 0;
+		VideoScaler::Filter filter = VideoScaler::Filter::Box;
+	} _layout;
+
+	struct {
+		uint32_t sourcesCount = 0;
+		uint32_t connectedTiles = 0;
+		uint32_t failedTiles = 0;
+
+		bool isErrored = false;
+		std::string errorMessage;
+		std::string warningMessage;
+	} _state;
+
+	/// Updates the tiles to match the requested sources, keeping the
+	/// receivers of the sources that did not move
+	void updateTiles();
+
+	/// Tries to connect the tiles whose source is on the network, and
+	/// refreshes the status of every tile
+	void connectTiles(const NDIlib_source_t * sources, uint32_t sourcesCount);
+
+	/// Starts the receive thread of a connected tile
+	void startReceiving(Tile &tile);
+
+	/// Stops the receive thread of a tile and closes its connection
+	void stopReceiving(Tile &tile);
+
+	/// Continuously captures and scales the frames of a tile
+	void receiveLoop(Tile * tile);
+
+	/// Lays the grid out for the given canvas size, telling every tile its
+	/// new area. Does nothing if the layout did not change.
+	void updateLayout(int width, int height);
+
+	/// Computes the area of a tile in the canvas, in pixels
+	void getTileRect(int index, int &x, int &y, int &width, int &height) const;
+
+	/// Draws a tile in the canvas if its image or status changed
+	/// @returns True if the canvas was modified
+	bool drawTile(int index);
+
+	/// Fills a rectangle of the canvas with a single color
+	void fillRect(int x, int y, int width, int height, uint32_t color);
+};
@@ -9,16 +9,56 @@
 #include "NDIOutTOP.h"
 
 #include "../Utils/fast_memcpy.h"
+#include "../Utils/frame_hasher.hpp"
+#include "../Utils/worker_pool.hpp"
+#include "../Utils/yuv_converter.hpp"
 
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <algorithm>
+#include <cctype>
 #include <cmath>
+#include <cstdlib>
+#include <functional>
 #include <random>
 #include <chrono>
 
 #include <iostream>
 
+/// Turns a frame rate into the fraction NDI expects. NTSC rates
+/// (23.976, 29.97, 59.94...) are expressed over 1001.
+static void toFrameRate(double rate, int &frameRateN, int &frameRateD) {
+	if(rate <= 0)
+		rate = 60;
+
+	if(std::abs(rate - std::round(rate)) < .001) {
+		frameRateN = static_cast<int>(std::round(rate));
+		frameRateD = 1;
+	} else if(std::abs(rate * 1.001 - std::round(rate * 1.001)) < .001) {
+		frameRateN = static_cast<int>(std::round(rate * 1.001)) * 1000;
+		frameRateD = 1001;
+	} else {
+		frameRateN = std::max(1, static_cast<int>(std::round(rate * 1000)));
+		frameRateD = 1000;
+	}
+}
+
+/// Tell if the given OpenGL internal format stores half floats. They are
+/// downloaded as is, other formats are downloaded as 16 bits integers.
+static bool isHalfFloatFormat(GLint pixelFormat) {
+	switch(pixelFormat) {
+		case 0x881A:  // GL_RGBA16F
+		case 0x881B:  // GL_RGB16F
+		case 0x881C:  // GL_ALPHA16F_ARB
+		case 0x822F:  // GL_RG16F
+		case 0x822D:  // GL_R16F
+			return true;
+		default:
+			return false;
+	}
+}
+
 NDIOutTOP::NDIOutTOP(const OP_NodeInfo *) {
 	if(!NDIlib_initialize()) {
 		_isErrored = true;
@@ -35,11 +75,14 @@ NDIOutTOP::NDIOutTOP(const OP_NodeInfo *) {
 	_videoFrame.picture_aspect_ratio = 0;
 	_videoFrame.frame_format_type = NDIlib_frame_format_type_progressive;
 	_videoFrame.timecode = 0LL;
-
-	_audioFrame.p_data = nullptr;
 }
 
 NDIOutTOP::~NDIOutTOP() {
+	stopPlayout();
+	destroyRegions();
+	destroyProxies();
+	_sender.stop();
+	_audioSender.stop();
 	NDIlib_send_destroy(_feed);
 	NDIlib_destroy();
 }
@@ -50,32 +93,96 @@ void NDIOutTOP::getGeneralInfo(TOP_GeneralInfo * ginfo, const OP_Inputs * inputs
 
 	// get parameters
 	_params.active = inputs->getParInt("Active");
-	_params.fps = static_cast<std::uint8_t>(inputs->getTimeInfo()->rate);
 
-	std::string parGroups = getGroups(inputs);
-	std::string parSourceName = inputs->getParString("Sourcename");
+	const std::string frameRatePar = inputs->getParString("Framerate");
+	const double frameRate = frameRatePar == "Timeline" ? inputs->getTimeInfo()->rate : std::atof(frameRatePar.c_str()) / 1000.;
+	toFrameRate(frameRate, _params.frameRateN, _params.frameRateD);
+
+	_params.pacedSend = inputs->getParInt("Pacedsend");
+	_params.clockAudio = inputs->getParInt("Clockaudio");
+	_params.audioRate = std::atoi(inputs->getParString("Audiorate"));
+
+	_params.idleWhenUnconnected = inputs->getParInt("Idlewhenunconnected");
+
+	_params.tallyThrottle = inputs->getParInt("Tallythrottle");
+	_params.previewRate = inputs->getParDouble("Previewrate");
+	_params.untalliedFPS = inputs->getParDouble("Untalliedfps");
+
+	const std::string untalliedResolutionPar = inputs->getParString("Untalliedresolution");
+	_params.untalliedDivisor = untalliedResolutionPar == "Quarter" ? 4 : untalliedResolutionPar == "Half" ? 2 : 1;
+
+	inputs->enablePar("Previewrate", _params.tallyThrottle);
+	inputs->enablePar("Untalliedfps", _params.tallyThrottle);
+	inputs->enablePar("Untalliedresolution", _params.tallyThrottle);
+
+	const bool dedupe = inputs->getParInt("Dedupe");
+
+	// The last hash is not kept up to date while disabled
+	if(dedupe != _params.dedupe)
+		resetDedupe();
+
+	_params.dedupe = dedupe;
+	_params.maxHold = inputs->getParDouble("Maxhold");
+
+	inputs->enablePar("Maxhold", _params.dedupe);
+
+	const std::string sendFormatPar = inputs->getParString("Sendformat");
+	const SendFormat previousSendFormat = _params.sendFormat;
+
+	if(sendFormatPar == "BGRX")
+		_params.sendFormat = SendFormat::BGRX;
+	else if(sendFormatPar == "UYVY")
+		_params.sendFormat = SendFormat::UYVY;
+	else if(sendFormatPar == "UYVA")
+		_params.sendFormat = SendFormat::UYVA;
+	else if(sendFormatPar == "P216")
+		_params.sendFormat = SendFormat::P216;
+	else if(sendFormatPar == "PA16")
+		_params.sendFormat = SendFormat::PA16;
+	else
+		_params.sendFormat = SendFormat::BGRA;
+
+	if(_params.sendFormat != previousSendFormat)
+		resetDedupe();
+
+	updateGroups(inputs);
+	_params.sourceName = inputs->getParString("Sourcename");
 
 	// Is there already a feed ?
 	if(_feed) {
 		// Check the feed options againt the user's parameters
-		if(!_params.active ||
-		   std::string(_feedSettings.p_ndi_name) != parSourceName ||
-		   std::string(_feedSettings.p_groups) != parGroups) {
-			// Mismatch, end the feed
+		const bool recreate = needsRecreation();
+
+		if(!_params.active || recreate) {
+			if(recreate)
+				++_senderRecreations;
+
+			// Mismatch, end the feed. The playout restarts with the new one.
+			stopPlayout();
+			_params.playoutFile = "";
+			destroyRegions();
+			destroyProxies();
+			_sender.stop();
+			_audioSender.stop();
 			NDIlib_send_destroy(_feed);
 
 			_feed = nullptr;
 		}
 	}
 
-	_params.sourceName = parSourceName;
-	_params.groups = parGroups;
-
 	// Do we need to create a feed ?
 	if(!_feed && _params.active) {
-		_feedSettings.p_ndi_name = _params.sourceName.c_str();
-		_feedSettings.p_groups = _params.groups.c_str();
-		_feedSettings.clock_audio = false;
+		// Our copies outlive the feed, the parameters may change meanwhile
+		_feedConfig.name = _params.sourceName;
+		_feedConfig.groups = _params.groups;
+		_feedConfig.clockAudio = _params.clockAudio;
+
+		_feedSettings.p_ndi_name = _feedConfig.name.c_str();
+		_feedSettings.p_groups = _feedConfig.groups.empty() ? nullptr : _feedConfig.groups.c_str();
+		_feedSettings.clock_audio = _feedConfig.clockAudio;
+
+		// The sender thread paces the frames itself
+		_feedSettings.clock_video = false;
 
 		_feed = NDIlib_send_create(&_feedSettings);
 
@@ -84,26 +191,50 @@ void NDIOutTOP::getGeneralInfo(TOP_GeneralInfo * ginfo, const OP_Inputs * inputs
 			_errorMessage = "Could not initialized NDI. CPU may be not supported.";
 			return;
 		}
+
+		_sender.start(_feed);
+		_audioSender.start(_feed);
+		resetDedupe();
+		_metadataDirty = true;
 	}
 
+	updatePlayout(inputs);
+	updateRegions(inputs);
+	updateProxies(inputs);
+	updatePacing();
+
 	if(!_feed) {
 		return;
 	}
 
-	// Update the feed metadata
-	NDIlib_send_clear_connection_metadata(_feed);
+	updateConnectionMetadata(inputs);
+}
 
-	_feedMetadata.timecode = (std::uint32_t)(inputs->getTimeInfo()->absFrame / inputs->getTimeInfo()->rate);
+bool NDIOutTOP::getOutputFormat(TOP_OutputFormat * format, const OP_Inputs * inputs, void *) {
+	const std::string previewPar = inputs->getParString("Preview");
 
-	const OP_DATInput * metadataDAT = inputs->getParDAT("Metadatadat");
-	if(metadataDAT) {
-		_feedMetadata.p_data = const_cast<char*>(metadataDAT->getCell(0, 0));
-		NDIlib_send_add_connection_metadata(_feed, &_feedMetadata);
+	if(previewPar == "Thumbnail")
+		_params.preview = PreviewMode::Thumbnail;
+	else if(previewPar == "None")
+		_params.preview = PreviewMode::None;
+	else
+		_params.preview = PreviewMode::Full;
+
+	// Same as the input
+	if(_params.preview == PreviewMode::Full || inputs->getNumInputs() == 0)
+		return false;
+
+	if(_params.preview == PreviewMode::Thumbnail) {
+		const OP_TOPInput * inputTOP = inputs->getInputTOP(0);
+		VideoScaler::fitInside(inputTOP->width, inputTOP->height,
+							   thumbnailSize, thumbnailSize,
+							   format->width, format->height);
+	} else {
+		format->width = 1;
+		format->height = 1;
 	}
-}
 
-bool NDIOutTOP::getOutputFormat(TOP_OutputFormat *, const OP_Inputs *, void *) {
-	return false;
+	return true;
 }
 
 
@@ -112,30 +243,115 @@ void NDIOutTOP::execute(TOP_OutputFormatSpecs * output, const OP_Inputs * inputs
 	if(_isErrored)
 		return;
 
+	// Video and audio share the timeline as time base. It runs at the
+	// timeline rate whatever the frame rate announced.
+	const OP_TimeInfo * cookTimeInfo = inputs->getTimeInfo();
+
+	if(cookTimeInfo->rate > 0)
+		_frameTimecode = static_cast<int64_t>(cookTimeInfo->absFrame * 10000000LL / cookTimeInfo->rate);
+
 	// Send audio
 	const OP_CHOPInput * audioCHOP = inputs->getParCHOP("Audiochop");
 
-	if(audioCHOP && audioCHOP->numChannels * audioCHOP->numSamples != 0) {
-		constexpr size_t floatSize = sizeof(float);
+	if(_feed && audioCHOP && audioCHOP->numChannels * audioCHOP->numSamples != 0 && audioCHOP->sampleRate > 0) {
+		_audioChannels.resize(audioCHOP->numChannels);
+
+		for(int i = 0; i < audioCHOP->numChannels; ++i)
+			_audioChannels[i] = audioCHOP->getChannelData(i);
 
-		// Fill the frame
-		_audioFrame.sample_rate = static_cast<int>(audioCHOP->sampleRate);
-		_audioFrame.no_channels = audioCHOP->numChannels;
-		_audioFrame.no_samples = audioCHOP->numSamples;
-		_audioFrame.timecode = static_cast<std::int64_t>(audioCHOP->startIndex);
-		_audioFrame.channel_stride_in_bytes = floatSize * audioCHOP->numSamples;
+		// The slice ends with this cook, packets last a video frame
+		const int sampleRate = static_cast<int>(std::round(audioCHOP->sampleRate));
+		const int sendRate = _params.audioRate > 0 ? _params.audioRate : sampleRate;
+		const int packetSize = static_cast<int>(std::round(static_cast<double>(sendRate) * _params.frameRateD / _params.frameRateN));
+		const int64_t timecode = _frameTimecode - audioCHOP->numSamples * 10000000LL / sampleRate;
 
-		_audioFrame.p_data = const_cast<float *>(audioCHOP->channelData[0]);
+		_audioSender.push(_audioChannels.data(), audioCHOP->numChannels, audioCHOP->numSamples,
+						  sampleRate, sendRate, std::max(1, packetSize), timecode);
+	}
 
-		// Send
-		NDIlib_send_send_audio_v2(_feed, &_audioFrame);
-		_audioFrame.p_data = nullptr;
+	// The playout thread sends the video, leave the input alone
+	if(_params.playout) {
+		output->newCPUPixelDataLocation = -1;
+		resetDedupe();
+		return;
 	}
 
+	updateFrameMetadata(inputs);
+
 	// Send video
 	if(inputs->getNumInputs() != 0) {
-		// Get frame data
 		const OP_TOPInput * inputTOP = inputs->getInputTOP(0);
+		const OP_TimeInfo * timeInfo = inputs->getTimeInfo();
+
+		// 16 bits formats need a 16 bits download
+		OP_CPUMemPixelType pixelType = OP_CPUMemPixelType::BGRA8Fixed;
+
+		if(_params.sendFormat == SendFormat::P216 || _params.sendFormat == SendFormat::PA16)
+			pixelType = isHalfFloatFormat(inputTOP->pixelFormat) ? OP_CPUMemPixelType::RGBA16Float : OP_CPUMemPixelType::RGBA16Fixed;
+
+		const bool isDeep = pixelType != OP_CPUMemPixelType::BGRA8Fixed;
+
+		// No one to send to, do not even download the frame
+		const bool mainIdle = _params.idleWhenUnconnected && _feed && _sender.getConnectionsCount() == 0;
+		_isIdle = mainIdle && areRegionsUnconnected() && areProxiesUnconnected();
+
+		if(_isIdle) {
+			++_idleSkippedFrames;
+			_idleSavedBytes += static_cast<uint64_t>(inputTOP->width) * inputTOP->height * (isDeep ? 8 : 4);
+			output->newCPUPixelDataLocation = -1;
+			return;
+		}
+
+		// The tally only throttles the main feed, regions have their own
+		int divisor = 1;
+		bool sendMain = !mainIdle;
+
+		if(sendMain && isThrottled(timeInfo, divisor)) {
+			++_throttledFrames;
+			sendMain = false;
+
+			if(_regions.empty() && _proxies.empty()) {
+				output->newCPUPixelDataLocation = -1;
+				return;
+			}
+		}
+
+		// The input did not cook since the frame we last sent, no need to
+		// download it again
+		const bool inputUnchanged = inputTOP->totalCooks == _previousInputCooks;
+		_previousInputCooks = inputTOP->totalCooks;
+
+		if(_params.dedupe && _feed &&
+		   inputUnchanged &&
+		   _frameMetadataHash == _settledMetadataHash &&
+		   inputTOP->totalCooks == _settledInputCooks &&
+		   divisor == _settledDivisor) {
+			++_unchangedCooks;
+
+			if(sendMain)
+				holdFrame(_sender, _lastQueuedFrame, timeInfo);
+
+			for(const std::unique_ptr<Region> &region: _regions)
+				holdFrame(region->sender, region->lastQueuedFrame, timeInfo);
+
+			for(const std::unique_ptr<Proxy> &proxy: _proxies)
+				holdFrame(proxy->sender, proxy->lastQueuedFrame, timeInfo);
+
+			output->newCPUPixelDataLocation = -1;
+			return;
+		}
+
+		// The download is delayed, the one we would get now was requested
+		// with the previous pixel type. Skip it and request the new type.
+		if(pixelType != _GPUDownloadOptions.cpuMemPixelType) {
+			_GPUDownloadOptions.cpuMemPixelType = pixelType;
+			inputs->getTOPDataInCPUMemory(inputTOP, &_GPUDownloadOptions);
+			resetDedupe();
+			output->newCPUPixelDataLocation = -1;
+			return;
+		}
+
+		// Get frame data
 		void * inputPtr = inputs->getTOPDataInCPUMemory(inputTOP, &_GPUDownloadOptions);
 
 		// Do we have an input frame ?
@@ -144,39 +360,520 @@ void NDIOutTOP::execute(TOP_OutputFormatSpecs * output, const OP_Inputs * inputs
 			return;
 		}
 
-		memcpy_fast(output->cpuPixelData[0], inputPtr, inputTOP->width * inputTOP->height * 4);
+		const uint8_t * inputPixels = static_cast<const uint8_t *>(inputPtr);
+
+		// Only the main feed at full resolution goes on 16 bits, everything
+		// else works on BGRA
+		const bool sendDeep = isDeep && sendMain && divisor == 1 && inputTOP->width % 2 == 0;
+		const uint8_t * bgraPixels = inputPixels;
+
+		if(isDeep) {
+			const bool needsBGRA = _params.preview != PreviewMode::None ||
+								   (sendMain && !sendDeep) ||
+								   !_regions.empty() ||
+								   !_proxies.empty();
 
-		output->newCPUPixelDataLocation = 0;
+			bgraPixels = nullptr;
+
+			if(needsBGRA) {
+				_narrowBuffer.resize(static_cast<size_t>(inputTOP->width) * inputTOP->height * 4);
+				YUVConverter::rgba16ToBGRA(inputPixels, inputTOP->width * 8,
+										   pixelType == OP_CPUMemPixelType::RGBA16Float,
+										   _narrowBuffer.data(), inputTOP->width * 4,
+										   inputTOP->width, inputTOP->height,
+										   _pool.get());
+				bgraPixels = _narrowBuffer.data();
+			}
+		}
+
+		updatePreview(output, inputTOP, bgraPixels);
 
 		if(!_feed)  // No feed, no frame
 			return;
 
-		// Fill
-		_videoFrame.xres = inputTOP->width;
-		_videoFrame.yres = inputTOP->height;
-		_videoFrame.frame_rate_N = _params.fps;
-		_videoFrame.line_stride_in_bytes = inputTOP->width * 4;
-		_videoFrame.p_data = reinterpret_cast<std::uint8_t *>(output->cpuPixelData[0]);
+		// This download shows the input as of its current cook count, once
+		// every output has it
+		bool settled = inputUnchanged && sendMain;
+
+		if(sendMain) {
+			uint64_t * lastHash = _params.dedupe ? &_lastFrameHash : nullptr;
+			QueueResult result;
+
+			if(sendDeep) {
+				result = queueFrame(_sender, inputPixels, inputTOP->width * 8, inputTOP->width, inputTOP->height, lastHash, pixelType);
+			} else if(divisor == 1) {
+				result = queueFrame(_sender, bgraPixels, inputTOP->width * 4, inputTOP->width, inputTOP->height, lastHash);
+			} else {
+				// Reduced resolution
+				const int width = std::max(1, inputTOP->width / divisor);
+				const int height = std::max(1, inputTOP->height / divisor);
+
+				_throttleBuffer.resize(static_cast<size_t>(width) * height * 4);
+				_throttleScaler.configure(inputTOP->width, inputTOP->height, width, height, VideoScaler::Filter::Box);
+				_throttleScaler.process(bgraPixels, inputTOP->width * 4,
+										_throttleBuffer.data(), width * 4,
+										_pool.get());
+
+				result = queueFrame(_sender, _throttleBuffer.data(), width * 4, width, height, lastHash);
+			}
+
+			if(!handleQueueResult(result, _sender, _lastQueuedFrame, timeInfo))
+				settled = false;
+		}
+
+		if(!queueRegions(bgraPixels, inputTOP->width, inputTOP->height, timeInfo))
+			settled = false;
+
+		if(!queueProxies(bgraPixels, inputTOP->width, inputTOP->height, timeInfo))
+			settled = false;
+
+		if(settled) {
+			_settledInputCooks = inputTOP->totalCooks;
+			_settledDivisor = divisor;
+			_settledMetadataHash = _frameMetadataHash;
+		}
+	}
+}
+
+void NDIOutTOP::holdFrame(VideoSender &sender, int64_t &lastQueuedFrame, const OP_TimeInfo * timeInfo) {
+	const double held = (timeInfo->absFrame - lastQueuedFrame) / timeInfo->rate;
+
+	// Timeline jumped backward, or held for too long
+	if(held < 0 || held >= _params.maxHold) {
+		sender.repeat();
+		lastQueuedFrame = timeInfo->absFrame;
+		return;
+	}
+
+	++_heldFrames;
+}
+
+bool NDIOutTOP::handleQueueResult(QueueResult result, VideoSender &sender, int64_t &lastQueuedFrame, const OP_TimeInfo * timeInfo) {
+	switch(result) {
+		case QueueResult::Dropped:
+			return false;
+		case QueueResult::Duplicate:
+			++_duplicateFrames;
+			holdFrame(sender, lastQueuedFrame, timeInfo);
+			return true;
+		case QueueResult::Queued:
+			lastQueuedFrame = timeInfo->absFrame;
+			return true;
+	}
+
+	return true;
+}
+
+void NDIOutTOP::updatePacing() {
+	// The playout thread has its own clock
+	const bool paced = _params.pacedSend && !_params.playout;
+	const int frameRateN = paced ? _params.frameRateN : 0;
+
+	_sender.setPacing(frameRateN, _params.frameRateD);
+
+	for(const std::unique_ptr<Region> &region: _regions)
+		region->sender.setPacing(frameRateN, _params.frameRateD);
+
+	int proxyFrameRateN = _params.frameRateN;
+	int proxyFrameRateD = _params.frameRateD;
+
+	if(_proxyFPS > 0)
+		toFrameRate(_proxyFPS, proxyFrameRateN, proxyFrameRateD);
+
+	for(const std::unique_ptr<Proxy> &proxy: _proxies)
+		proxy->sender.setPacing(paced ? proxyFrameRateN : 0, proxyFrameRateD);
+}
+
+void NDIOutTOP::updateConnectionMetadata(const OP_Inputs * inputs) {
+	const OP_DATInput * metadataDAT = inputs->getParDAT("Metadatadat");
+	const char * metadataDATPath = metadataDAT ? metadataDAT->opPath : "";
+	const int64_t metadataCookCount = metadataDAT ? metadataDAT->totalCooks : -1;
+
+	if(!_metadataDirty &&
+	   _metadataDATPath == metadataDATPath &&
+	   _metadataCookCount == metadataCookCount)
+		return;
+
+	_metadataDirty = false;
+	_metadataDATPath = metadataDATPath;
+	_metadataCookCount = metadataCookCount;
+
+	NDIlib_send_clear_connection_metadata(_feed);
 
-#ifdef _WIN32
-		NDIlib_send_send_video_v2(_feed, &_videoFrame);
-#else
-		NDIlib_send_send_video_async_v2(_feed, &_videoFrame);
-#endif
+	if(metadataDAT) {
+		_feedMetadata.timecode = (std::uint32_t)(inputs->getTimeInfo()->absFrame / inputs->getTimeInfo()->rate);
+		_feedMetadata.p_data = const_cast<char*>(metadataDAT->getCell(0, 0));
+		NDIlib_send_add_connection_metadata(_feed, &_feedMetadata);
 	}
 }
 
+/// Appends a valid XML attribute name, replacing unsupported characters
+static void appendXMLName(std::string &xml, const char * name) {
+	if(!std::isalpha(static_cast<unsigned char>(*name)) && *name != '_')
+		xml += '_';
+
+	for(; *name != '\0'; ++name) {
+		const unsigned char c = static_cast<unsigned char>(*name);
+		xml += std::isalnum(c) || c == '_' || c == '-' || c == '.' ? *name : '_';
+	}
+}
+
+/// Appends an XML attribute value, escaping it
+static void appendXMLValue(std::string &xml, const char * value) {
+	for(; *value != '\0'; ++value) {
+		switch(*value) {
+			case '&': xml += "&amp;"; break;
+			case '<': xml += "&lt;"; break;
+			case '>': xml += "&gt;"; break;
+			case '"': xml += "&quot;"; break;
+			default: xml += *value;
+		}
+	}
+}
+
+void NDIOutTOP::updateFrameMetadata(const OP_Inputs * inputs) {
+	const OP_DATInput * metadataDAT = inputs->getParDAT("Framemetadatadat");
+	const OP_CHOPInput * metadataCHOP = inputs->getParCHOP("Framemetadatachop");
+
+	// Keeps its capacity, no allocation once warmed up
+	_frameMetadata.clear();
+
+	if(metadataDAT && !metadataDAT->isTable) {
+		// A text DAT is expected to hold XML already
+		_frameMetadata += metadataDAT->getCell(0, 0);
+	} else if(metadataDAT || metadataCHOP) {
+		// <td_metadata name="value" .../>, from the DAT name/value rows
+		// and the CHOP channels last sample
+		_frameMetadata += "<td_metadata";
+
+		for(int i = 0; metadataDAT && metadataDAT->numCols >= 2 && i < metadataDAT->numRows; ++i) {
+			const char * name = metadataDAT->getCell(i, 0);
+
+			if(*name == '\0')
+				continue;
+
+			_frameMetadata += ' ';
+			appendXMLName(_frameMetadata, name);
+			_frameMetadata += "=\"";
+			appendXMLValue(_frameMetadata, metadataDAT->getCell(i, 1));
+			_frameMetadata += '"';
+		}
+
+		for(int i = 0; metadataCHOP && metadataCHOP->numSamples > 0 && i < metadataCHOP->numChannels; ++i) {
+			char value[32];
+			snprintf(value, sizeof(value), "%g", metadataCHOP->getChannelData(i)[metadataCHOP->numSamples - 1]);
+
+			_frameMetadata += ' ';
+			appendXMLName(_frameMetadata, metadataCHOP->getChannelName(i));
+			_frameMetadata += "=\"";
+			_frameMetadata += value;
+			_frameMetadata += '"';
+		}
+
+		_frameMetadata += "/>";
+	}
+
+	_frameMetadataHash = _frameMetadata.empty() ? 0 : std::hash<std::string>()(_frameMetadata);
+}
+
+void NDIOutTOP::resetDedupe() {
+	_previousInputCooks = -1;
+	_settledInputCooks = -1;
+	_lastFrameHash = 0;
+
+	for(const std::unique_ptr<Region> &region: _regions)
+		region->lastHash = 0;
+
+	for(const std::unique_ptr<Proxy> &proxy: _proxies)
+		proxy->lastHash = 0;
+}
+
+bool NDIOutTOP::isThrottled(const OP_TimeInfo * timeInfo, int &divisor) {
+	divisor = 1;
+
+	if(!_params.tallyThrottle || !_feed || _sender.isOnProgram())
+		return false;
+
+	double rate = timeInfo->rate * _params.previewRate;
+
+	if(!_sender.isOnPreview()) {
+		rate = _params.untalliedFPS;
+		divisor = _params.untalliedDivisor;
+	}
+
+	// Frames between two sends, at least one
+	const double interval = std::max(1., timeInfo->rate / std::max(rate, .001));
+	const int64_t elapsed = timeInfo->absFrame - _lastSentFrame;
+
+	// Too soon, unless the timeline jumped backward
+	if(elapsed >= 0 && elapsed + .5 < interval)
+		return true;
+
+	_lastSentFrame = timeInfo->absFrame;
+	return false;
+}
+
+NDIOutTOP::QueueResult NDIOutTOP::queueFrame(VideoSender &sender, const uint8_t * pixels, int stride, int width, int height, uint64_t * lastHash,
+											 OP_CPUMemPixelType pixelType) {
+	const bool isDeepSource = pixelType != OP_CPUMemPixelType::BGRA8Fixed;
+	SendFormat format = _params.sendFormat;
+
+	// 16 bits formats are only sent from 16 bits frames
+	if(!isDeepSource && format == SendFormat::P216)
+		format = SendFormat::UYVY;
+	else if(!isDeepSource && format == SendFormat::PA16)
+		format = SendFormat::UYVA;
+
+	// UYVY pairs pixels horizontally
+	if(width % 2 != 0 && (format == SendFormat::UYVY || format == SendFormat::UYVA))
+		format = SendFormat::BGRA;
+
+	const bool isYUV = format == SendFormat::UYVY || format == SendFormat::UYVA;
+	const bool isDeep = format == SendFormat::P216 || format == SendFormat::PA16;
+	const bool isConverted = isYUV || isDeep;
+
+	// Two bytes per component for P216, the CbCr plane has the same stride
+	// as the luma one
+	const int lineStride = isConverted ? width * 2 : width * 4;
+
+	size_t frameSize = static_cast<size_t>(lineStride) * height;
+
+	if(format == SendFormat::UYVA)
+		frameSize += static_cast<size_t>(width) * height;
+	else if(format == SendFormat::P216)
+		frameSize *= 2;
+	else if(format == SendFormat::PA16)
+		frameSize *= 3;
+
+	// Hash the source pixels before converting them, so duplicates are
+	// not converted. The format and metadata are mixed in as the source
+	// does not change with them.
+	uint64_t hash = 0;
+
+	if(lastHash && isConverted) {
+		hash = FrameHasher::hash(pixels, stride, width * (isDeepSource ? 8 : 4), height, _pool.get()) + static_cast<uint64_t>(format) + _frameMetadataHash;
+
+		if(hash == *lastHash)
+			return QueueResult::Duplicate;
+	}
+
+	// Copy the frame in one of our buffers, the output one is slow to
+	// read and reused by TouchDesigner
+	std::unique_ptr<VideoSender::Buffer> buffer = sender.acquire(frameSize);
+
+	if(!buffer)  // Every buffer is still in use
+		return QueueResult::Dropped;
+
+	if(lastHash && !isConverted) {
+		// Hash while copying, the pixels are only read once
+		hash = FrameHasher::copyAndHash(buffer->data, lineStride,
+										pixels, stride,
+										lineStride, height,
+										_pool.get()) + static_cast<uint64_t>(format) + _frameMetadataHash;
+
+		if(hash == *lastHash) {
+			sender.recycle(std::move(buffer));
+			return QueueResult::Duplicate;
+		}
+	} else if(isYUV) {
+		// The alpha plane follows the UYVY one
+		uint8_t * alpha = format == SendFormat::UYVA ? buffer->data + lineStride * height : nullptr;
+
+		YUVConverter::bgraToUYVY(pixels, stride,
+								 buffer->data, lineStride,
+								 alpha, width,
+								 width, height,
+								 YUVConverter::matrixFor(height),
+								 _pool.get());
+	} else if(isDeep) {
+		// The alpha plane follows the CbCr one
+		uint8_t * alpha = format == SendFormat::PA16 ? buffer->data + static_cast<size_t>(lineStride) * height * 2 : nullptr;
+
+		YUVConverter::rgba16ToP216(pixels, stride,
+								   pixelType == OP_CPUMemPixelType::RGBA16Float,
+								   buffer->data, lineStride,
+								   alpha, lineStride,
+								   width, height,
+								   YUVConverter::matrixFor(height),
+								   _pool.get());
+	} else if(stride == lineStride) {
+		memcpy_fast(buffer->data, pixels, frameSize);
+	} else {
+		// Cropped, copy the rows in parallel
+		uint8_t * data = buffer->data;
+
+		_pool->parallelFor(height, [&](int begin, int end) {
+			for(int y = begin; y < end; ++y) {
+				memcpy_fast(data + y * lineStride, pixels + y * stride, lineStride);
+			}
+		});
+	}
+
+	NDIlib_video_frame_v2_t videoFrame = _videoFrame;
+
+	switch(format) {
+		case SendFormat::BGRA: videoFrame.FourCC = NDIlib_FourCC_video_type_BGRA; break;
+		case SendFormat::BGRX: videoFrame.FourCC = NDIlib_FourCC_video_type_BGRX; break;
+		case SendFormat::UYVY: videoFrame.FourCC = NDIlib_FourCC_video_type_UYVY; break;
+		case SendFormat::UYVA: videoFrame.FourCC = NDIlib_FourCC_video_type_UYVA; break;
+		case SendFormat::P216: videoFrame.FourCC = NDIlib_FourCC_video_type_P216; break;
+		case SendFormat::PA16: videoFrame.FourCC = NDIlib_FourCC_video_type_PA16; break;
+	}
+
+	// Fill
+	videoFrame.xres = width;
+	videoFrame.yres = height;
+	videoFrame.frame_rate_N = _params.frameRateN;
+	videoFrame.frame_rate_D = _params.frameRateD;
+	videoFrame.line_stride_in_bytes = lineStride;
+	videoFrame.timecode = _frameTimecode;
+	videoFrame.p_data = nullptr;
+
+	// Reuses the buffer storage
+	buffer->metadata.assign(_frameMetadata);
+
+	sender.send(std::move(buffer), videoFrame);
+
+	if(lastHash)
+		*lastHash = hash;
+
+	return QueueResult::Queued;
+}
+
 int32_t NDIOutTOP::getNumInfoCHOPChans(void *) {
 	// We return the number of channel we want to output to any Info CHOP
-	// connected to the TOP. In this example we are just going to send one channel.
-	return 1;
+	// connected to the TOP.
+	return 28;
 }
 
-void NDIOutTOP::getInfoCHOPChan(int32_t, OP_InfoCHOPChan * chan, void *) {
+void NDIOutTOP::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan * chan, void *) {
 	// This function will be called once for each channel we said we'd want to return
-	// In this example it'll only be called once.
-	chan->name->setString("num_connected");
-	chan->value = static_cast<float>(NDIlib_send_get_no_connections(_feed, 1));
+	switch(index) {
+		case 0:
+			chan->name->setString("num_connected");
+			chan->value = static_cast<float>(_sender.getConnectionsCount());
+			break;
+		case 1:
+			chan->name->setString("playout_frame");
+			chan->value = static_cast<float>(_playoutFrame);
+			break;
+		case 2:
+			chan->name->setString("playout_frames");
+			chan->value = _playoutReader ? static_cast<float>(_playoutReader->getFramesCount()) : 0.f;
+			break;
+		case 3:
+			chan->name->setString("playout_sent_frames");
+			chan->value = static_cast<float>(_playoutSentFrames);
+			break;
+		case 4:
+			chan->name->setString("playout_skipped_frames");
+			chan->value = static_cast<float>(_playoutSkippedFrames);
+			break;
+		case 5:
+			chan->name->setString("playout_finished");
+			chan->value = _playoutFinished ? 1.f : 0.f;
+			break;
+		case 6:
+			chan->name->setString("sent_frames");
+			chan->value = static_cast<float>(_sender.getSentCount());
+			break;
+		case 7:
+			chan->name->setString("dropped_frames");
+			chan->value = static_cast<float>(_sender.getDroppedCount());
+			break;
+		case 8:
+			chan->name->setString("idle");
+			chan->value = _isIdle ? 1.f : 0.f;
+			break;
+		case 9:
+			chan->name->setString("idle_skipped_frames");
+			chan->value = static_cast<float>(_idleSkippedFrames);
+			break;
+		case 10:
+			chan->name->setString("idle_saved_mb");
+			chan->value = static_cast<float>(_idleSavedBytes / (1024. * 1024.));
+			break;
+		case 11:
+			chan->name->setString("on_program");
+			chan->value = _sender.isOnProgram() ? 1.f : 0.f;
+			break;
+		case 12:
+			chan->name->setString("on_preview");
+			chan->value = _sender.isOnPreview() ? 1.f : 0.f;
+			break;
+		case 13:
+			chan->name->setString("throttled_frames");
+			chan->value = static_cast<float>(_throttledFrames);
+			break;
+		case 14:
+			chan->name->setString("unchanged_cooks");
+			chan->value = static_cast<float>(_unchangedCooks);
+			break;
+		case 15:
+			chan->name->setString("duplicate_frames");
+			chan->value = static_cast<float>(_duplicateFrames);
+			break;
+		case 16:
+			chan->name->setString("held_frames");
+			chan->value = static_cast<float>(_heldFrames);
+			break;
+		case 17:
+			chan->name->setString("repeated_frames");
+			chan->value = static_cast<float>(_sender.getRepeatedCount());
+			break;
+		case 18:
+			chan->name->setString("num_regions");
+			chan->value = static_cast<float>(_regions.size());
+			break;
+		case 19: {
+			int connected = 0;
+
+			for(const std::unique_ptr<Region> &region: _regions)
+				connected += region->sender.getConnectionsCount();
+
+			chan->name->setString("regions_connected");
+			chan->value = static_cast<float>(connected);
+			break;
+		}
+		case 20:
+			chan->name->setString("num_proxies");
+			chan->value = static_cast<float>(_proxies.size());
+			break;
+		case 21: {
+			int connected = 0;
+
+			for(const std::unique_ptr<Proxy> &proxy: _proxies)
+				connected += proxy->sender.getConnectionsCount();
+
+			chan->name->setString("proxies_connected");
+			chan->value = static_cast<float>(connected);
+			break;
+		}
+		case 22:
+			chan->name->setString("frame_rate");
+			chan->value = static_cast<float>(static_cast<double>(_params.frameRateN) / _params.frameRateD);
+			break;
+		case 23:
+			chan->name->setString("late_ticks");
+			chan->value = static_cast<float>(_sender.getLateTicksCount());
+			break;
+		case 24:
+			chan->name->setString("sender_recreations");
+			chan->value = static_cast<float>(_senderRecreations);
+			break;
+		case 25:
+			chan->name->setString("audio_sent_packets");
+			chan->value = static_cast<float>(_audioSender.getSentCount());
+			break;
+		case 26:
+			chan->name->setString("audio_dropped_packets");
+			chan->value = static_cast<float>(_audioSender.getDroppedCount());
+			break;
+		case 27:
+			chan->name->setString("audio_discontinuities");
+			chan->value = static_cast<float>(_audioSender.getDiscontinuitiesCount());
+			break;
+	}
 }
 
 bool	NDIOutTOP::getInfoDATSize(OP_InfoDATSize *, void *) {
@@ -200,23 +897,211 @@ void NDIOutTOP::setupParameters(OP_ParameterManager * manager, void *) {
 	sourceName.page = "NDI Out";
 	manager->appendString(sourceName);
 
+	OP_StringParameter preview;
+	preview.name = "Preview";
+	preview.label = "Preview";
+	preview.page = "NDI Out";
+	preview.defaultValue = "Full";
+	const char * previewNames[] = {"Full", "Thumbnail", "None"};
+	const char * previewLabels[] = {"Full Resolution", "Thumbnail", "None"};
+	manager->appendMenu(preview, 3, previewNames, previewLabels);
+
+	OP_StringParameter sendFormat;
+	sendFormat.name = "Sendformat";
+	sendFormat.label = "Send Format";
+	sendFormat.page = "NDI Out";
+	sendFormat.defaultValue = "BGRA";
+	const char * sendFormatNames[] = {"BGRA", "BGRX", "UYVY", "UYVA", "P216", "PA16"};
+	const char * sendFormatLabels[] = {"BGRA", "BGRX (No Alpha)", "UYVY", "UYVA (UYVY + Alpha)", "P216 (16 Bits)", "PA16 (P216 + Alpha)"};
+	manager->appendMenu(sendFormat, 6, sendFormatNames, sendFormatLabels);
+
+	OP_StringParameter frameRate;
+	frameRate.name = "Framerate";
+	frameRate.label = "Frame Rate";
+	frameRate.page = "NDI Out";
+	frameRate.defaultValue = "Timeline";
+	const char * frameRateNames[] = {"Timeline", "23976", "24000", "25000", "29970", "30000", "50000", "59940", "60000"};
+	const char * frameRateLabels[] = {"Timeline", "23.976", "24", "25", "29.97", "30", "50", "59.94", "60"};
+	manager->appendMenu(frameRate, 9, frameRateNames, frameRateLabels);
+
+	OP_NumericParameter pacedSend;
+	pacedSend.name = "Pacedsend";
+	pacedSend.label = "Paced Send";
+	pacedSend.page = "NDI Out";
+	pacedSend.defaultValues[0] = 0;
+	manager->appendToggle(pacedSend);
+
+	OP_NumericParameter idleToggle;
+	idleToggle.name = "Idlewhenunconnected";
+	idleToggle.label = "Idle When Unconnected";
+	idleToggle.page = "NDI Out";
+	idleToggle.defaultValues[0] = 0;
+	manager->appendToggle(idleToggle);
+
+	OP_NumericParameter dedupe;
+	dedupe.name = "Dedupe";
+	dedupe.label = "Skip Identical Frames";
+	dedupe.page = "NDI Out";
+	dedupe.defaultValues[0] = 0;
+	manager->appendToggle(dedupe);
+
+	OP_NumericParameter maxHold;
+	maxHold.name = "Maxhold";
+	maxHold.label = "Max Hold (s)";
+	maxHold.page = "NDI Out";
+	maxHold.defaultValues[0] = 1;
+	maxHold.minValues[0] = 0;
+	maxHold.clampMins[0] = true;
+	maxHold.minSliders[0] = 0;
+	maxHold.maxSliders[0] = 10;
+	manager->appendFloat(maxHold);
+
+	OP_NumericParameter tallyThrottle;
+	tallyThrottle.name = "Tallythrottle";
+	tallyThrottle.label = "Throttle From Tally";
+	tallyThrottle.page = "Tally";
+	tallyThrottle.defaultValues[0] = 0;
+	manager->appendToggle(tallyThrottle);
+
+	OP_NumericParameter previewRate;
+	previewRate.name = "Previewrate";
+	previewRate.label = "Preview Rate";
+	previewRate.page = "Tally";
+	previewRate.defaultValues[0] = .5;
+	previewRate.minValues[0] = 0;
+	previewRate.maxValues[0] = 1;
+	previewRate.clampMins[0] = true;
+	previewRate.clampMaxes[0] = true;
+	previewRate.minSliders[0] = 0;
+	previewRate.maxSliders[0] = 1;
+	manager->appendFloat(previewRate);
+
+	OP_NumericParameter untalliedFPS;
+	untalliedFPS.name = "Untalliedfps";
+	untalliedFPS.label = "Untallied FPS";
+	untalliedFPS.page = "Tally";
+	untalliedFPS.defaultValues[0] = 1;
+	untalliedFPS.minValues[0] = 0;
+	untalliedFPS.clampMins[0] = true;
+	untalliedFPS.minSliders[0] = 0;
+	untalliedFPS.maxSliders[0] = 60;
+	manager->appendFloat(untalliedFPS);
+
+	OP_StringParameter untalliedResolution;
+	untalliedResolution.name = "Untalliedresolution";
+	untalliedResolution.label = "Untallied Resolution";
+	untalliedResolution.page = "Tally";
+	untalliedResolution.defaultValue = "Quarter";
+	const char * untalliedResolutionNames[] = {"Full", "Half", "Quarter"};
+	manager->appendMenu(untalliedResolution, 3, untalliedResolutionNames, untalliedResolutionNames);
+
 	OP_StringParameter groups;
 	groups.name = "Groupstable";
 	groups.label = "Groups Table DAT";
 	groups.page = "NDI Out";
 	manager->appendDAT(groups);
 
+	OP_StringParameter regions;
+	regions.name = "Regionstable";
+	regions.label = "Regions Table DAT";
+	regions.page = "NDI Out";
+	manager->appendDAT(regions);
+
 	OP_StringParameter audioCHOP;
 	audioCHOP.name = "Audiochop";
 	audioCHOP.label = "Audio CHOP";
 	audioCHOP.page = "NDI Out";
 	manager->appendCHOP(audioCHOP);
 
+	OP_StringParameter audioRate;
+	audioRate.name = "Audiorate";
+	audioRate.label = "Audio Sample Rate";
+	audioRate.page = "NDI Out";
+	audioRate.defaultValue = "48000";
+	const char * audioRateNames[] = {"Source", "44100", "48000", "96000"};
+	const char * audioRateLabels[] = {"Same as CHOP", "44.1 kHz", "48 kHz", "96 kHz"};
+	manager->appendMenu(audioRate, 4, audioRateNames, audioRateLabels);
+
+	OP_NumericParameter clockAudio;
+	clockAudio.name = "Clockaudio";
+	clockAudio.label = "Clock Audio";
+	clockAudio.page = "NDI Out";
+	clockAudio.defaultValues[0] = 0;
+	manager->appendToggle(clockAudio);
+
 	OP_StringParameter metadataDAT;
 	metadataDAT.name = "Metadatadat";
 	metadataDAT.label = "Metadata DAT";
 	metadataDAT.page = "NDI Out";
 	manager->appendDAT(metadataDAT);
+
+	OP_StringParameter frameMetadataDAT;
+	frameMetadataDAT.name = "Framemetadatadat";
+	frameMetadataDAT.label = "Frame Metadata DAT";
+	frameMetadataDAT.page = "NDI Out";
+	manager->appendDAT(frameMetadataDAT);
+
+	OP_StringParameter frameMetadataCHOP;
+	frameMetadataCHOP.name = "Framemetadatachop";
+	frameMetadataCHOP.label = "Frame Metadata CHOP";
+	frameMetadataCHOP.page = "NDI Out";
+	manager->appendCHOP(frameMetadataCHOP);
+
+	OP_NumericParameter proxyHalf;
+	proxyHalf.name = "Proxyhalf";
+	proxyHalf.label = "Half Resolution Proxy";
+	proxyHalf.page = "Proxies";
+	proxyHalf.defaultValues[0] = 0;
+	manager->appendToggle(proxyHalf);
+
+	OP_NumericParameter proxyQuarter;
+	proxyQuarter.name = "Proxyquarter";
+	proxyQuarter.label = "Quarter Resolution Proxy";
+	proxyQuarter.page = "Proxies";
+	proxyQuarter.defaultValues[0] = 0;
+	manager->appendToggle(proxyQuarter);
+
+	OP_NumericParameter proxyFPS;
+	proxyFPS.name = "Proxyfps";
+	proxyFPS.label = "Proxy FPS (0 = Full)";
+	proxyFPS.page = "Proxies";
+	proxyFPS.defaultValues[0] = 0;
+	proxyFPS.minValues[0] = 0;
+	proxyFPS.clampMins[0] = true;
+	proxyFPS.minSliders[0] = 0;
+	proxyFPS.maxSliders[0] = 60;
+	manager->appendFloat(proxyFPS);
+
+	OP_NumericParameter playoutToggle;
+	playoutToggle.name = "Playout";
+	playoutToggle.label = "Playout";
+	playoutToggle.page = "Playout";
+	playoutToggle.defaultValues[0] = 0;
+	manager->appendToggle(playoutToggle);
+
+	OP_StringParameter playoutFile;
+	playoutFile.name = "Playoutfile";
+	playoutFile.label = "Playout File";
+	playoutFile.page = "Playout";
+	manager->appendFile(playoutFile);
+
+	OP_NumericParameter playoutLoop;
+	playoutLoop.name = "Playoutloop";
+	playoutLoop.label = "Loop";
+	playoutLoop.page = "Playout";
+	playoutLoop.defaultValues[0] = 1;
+	manager->appendToggle(playoutLoop);
+
+	OP_NumericParameter playoutPrefetch;
+	playoutPrefetch.name = "Playoutprefetch";
+	playoutPrefetch.label = "Prefetch Frames";
+	playoutPrefetch.page = "Playout";
+	playoutPrefetch.defaultValues[0] = 8;
+	playoutPrefetch.minSliders[0] = 1;
+	playoutPrefetch.maxSliders[0] = 64;
+	playoutPrefetch.minValues[0] = 1;
+	playoutPrefetch.clampMins[0] = true;
+	manager->appendInt(playoutPrefetch);
 }
 
 void NDIOutTOP::getErrorString(OP_String * error, void *) {
@@ -224,19 +1109,40 @@ void NDIOutTOP::getErrorString(OP_String * error, void *) {
 		error->setString(_errorMessage.c_str());
 }
 
-std::string NDIOutTOP::getGroups(const OP_Inputs * inputs) {
+void NDIOutTOP::getWarningString(OP_String * warning, void *) {
+	if(!_playoutError.empty())
+		warning->setString(_playoutError.c_str());
+	else if(!_regionsError.empty())
+		warning->setString(_regionsError.c_str());
+	else if(!_proxiesError.empty())
+		warning->setString(_proxiesError.c_str());
+}
+
+bool NDIOutTOP::needsRecreation() const {
+	return _feedConfig.name != _params.sourceName ||
+		   _feedConfig.groups != _params.groups ||
+		   _feedConfig.clockAudio != _params.clockAudio;
+}
+
+void NDIOutTOP::updateGroups(const OP_Inputs * inputs) {
 	const OP_DATInput * groupsDAT = inputs->getParDAT("Groupstable");
 
-	// Check if we really need to updates the groups before doing so
-	std::string parGroups;
+	// No table, no groups
+	if(groupsDAT == nullptr || !groupsDAT->isTable) {
+		_params.groupsDATPath = "";
+		_params.groupsCookCount = -1;
+		_params.groups = "";
+		return;
+	}
 
-	if(groupsDAT != nullptr &&
-	   groupsDAT->isTable && (
-	   groupsDAT->opPath != _params.groupsDATPath ||
-	   groupsDAT->totalCooks != _params.groupsCookCount)) {
+	// Check if we really need to updates the groups before doing so
+	if(groupsDAT->opPath != _params.groupsDATPath ||
+	   groupsDAT->totalCooks != _params.groupsCookCount) {
 		_params.groupsDATPath = groupsDAT->opPath;
 		_params.groupsCookCount = groupsDAT->totalCooks;
 
+		std::string parGroups;
+
 		for(int i = 0; i < groupsDAT->numRows; ++i) {
 			for(int j = 0; j < groupsDAT->numCols; ++j) {
 				if(strlen(groupsDAT->getCell(i, j)) == 0)
@@ -248,7 +1154,505 @@ std::string NDIOutTOP::getGroups(const OP_Inputs * inputs) {
 				parGroups += groupsDAT->getCell(i, j);
 			}
 		}
+
+		_params.groups = parGroups;
 	}
+}
+
+// MARK: - Preview
+
+void NDIOutTOP::updatePreview(TOP_OutputFormatSpecs * output, const OP_TOPInput * inputTOP, const uint8_t * inputPixels) {
+	uint8_t * outputPixels = static_cast<uint8_t *>(output->cpuPixelData[0]);
+	output->newCPUPixelDataLocation = 0;
+
+	if(inputPixels == nullptr) {
+		memset(outputPixels, 0, output->width * output->height * 4);
+		return;
+	}
+
+	// The output may not have followed the mode yet
+	if(output->width == inputTOP->width && output->height == inputTOP->height) {
+		memcpy_fast(outputPixels, inputPixels, inputTOP->width * inputTOP->height * 4);
+		return;
+	}
+
+	if(_params.preview == PreviewMode::Thumbnail) {
+		_previewScaler.configure(inputTOP->width, inputTOP->height,
+								 output->width, output->height,
+								 VideoScaler::Filter::Box);
+		_previewScaler.process(inputPixels, inputTOP->width * 4,
+							   outputPixels, output->width * 4,
+							   _pool.get());
+		return;
+	}
+
+	memset(outputPixels, 0, output->width * output->height * 4);
+}
+
+// MARK: - Regions
+
+void NDIOutTOP::updateRegions(const OP_Inputs * inputs) {
+	const OP_DATInput * regionsDAT = inputs->getParDAT("Regionstable");
+
+	if(!_feed || regionsDAT == nullptr || !regionsDAT->isTable) {
+		destroyRegions();
+		return;
+	}
+
+	// Only read the table when it changed
+	if(regionsDAT->opPath == _regionsDATPath && regionsDAT->totalCooks == _regionsCookCount)
+		return;
+
+	_regionsDATPath = regionsDAT->opPath;
+	_regionsCookCount = regionsDAT->totalCooks;
+	_regionsError.clear();
+
+	if(regionsDAT->numCols < 5) {
+		_regionsError = "The regions table needs name, x, y, width and height columns.";
+		destroyRegions();
+		return;
+	}
+
+	std::vector<std::unique_ptr<Region>> regions;
+
+	for(int i = 0; i < regionsDAT->numRows; ++i) {
+		const std::string name = regionsDAT->getCell(i, 0);
+
+		// Skip empty rows and the header
+		if(name.empty() || (i == 0 && name == "name"))
+			continue;
+
+		const auto isNamed = [&](const std::unique_ptr<Region> &region) { return region && region->name == name; };
+
+		if(std::any_of(regions.begin(), regions.end(), isNamed)) {
+			_regionsError = "Region " + name + " is listed more than once.";
+			continue;
+		}
+
+		// Keep the feed of a region with the same name
+		std::unique_ptr<Region> region;
+		auto existing = std::find_if(_regions.begin(), _regions.end(), isNamed);
+
+		if(existing != _regions.end()) {
+			region = std::move(*existing);
+		} else {
+			region.reset(new Region());
+			region->name = name;
+		}
+
+		region->x = std::atoi(regionsDAT->getCell(i, 1));
+		region->y = std::atoi(regionsDAT->getCell(i, 2));
+		region->width = std::atoi(regionsDAT->getCell(i, 3));
+		region->height = std::atoi(regionsDAT->getCell(i, 4));
+
+		regions.push_back(std::move(region));
+	}
+
+	// End the feeds of removed regions
+	destroyRegions();
+
+	for(std::unique_ptr<Region> &region: regions) {
+		if(!region->feed && !createExtraFeed(*region))
+			_regionsError = "Could not create the NDI source for region " + region->name + ".";
+	}
+
+	// Forget the regions without a feed
+	regions.erase(std::remove_if(regions.begin(), regions.end(), [](const std::unique_ptr<Region> &region) { return !region->feed; }),
+				  regions.end());
+
+	_regions = std::move(regions);
+
+	// Restore what destroyRegions() cleared
+	_regionsDATPath = regionsDAT->opPath;
+	_regionsCookCount = regionsDAT->totalCooks;
+}
+
+void NDIOutTOP::destroyRegions() {
+	for(const std::unique_ptr<Region> &region: _regions) {
+		if(region)  // Not moved to the new regions
+			destroyExtraFeed(*region);
+	}
+
+	_regions.clear();
+
+	// Read the table again with the next feed
+	_regionsDATPath = "";
+	_regionsCookCount = -1;
+}
+
+bool NDIOutTOP::areRegionsUnconnected() const {
+	for(const std::unique_ptr<Region> &region: _regions) {
+		if(region->sender.getConnectionsCount() > 0)
+			return false;
+	}
+
+	return true;
+}
+
+bool NDIOutTOP::queueRegions(const uint8_t * pixels, int width, int height, const OP_TimeInfo * timeInfo) {
+	bool allQueued = true;
+
+	for(const std::unique_ptr<Region> &region: _regions) {
+		if(_params.idleWhenUnconnected && region->sender.getConnectionsCount() == 0) {
+			allQueued = false;
+			continue;
+		}
+
+		// Keep the region inside the frame
+		const int x = std::max(0, std::min(region->x, width));
+		const int y = std::max(0, std::min(region->y, height));
+		const int regionWidth = std::min(region->x + region->width, width) - x;
+		const int regionHeight = std::min(region->y + region->height, height) - y;
+
+		if(regionWidth <= 0 || regionHeight <= 0)
+			continue;
+
+		const QueueResult result = queueFrame(region->sender,
+											  pixels + (static_cast<size_t>(y) * width + x) * 4, width * 4,
+											  regionWidth, regionHeight,
+											  _params.dedupe ? &region->lastHash : nullptr);
+
+		if(!handleQueueResult(result, region->sender, region->lastQueuedFrame, timeInfo))
+			allQueued = false;
+	}
+
+	return allQueued;
+}
+
+// MARK: - Proxies
+
+void NDIOutTOP::updateProxies(const OP_Inputs * inputs) {
+	const bool half = inputs->getParInt("Proxyhalf");
+	const bool quarter = inputs->getParInt("Proxyquarter");
+
+	_proxyFPS = inputs->getParDouble("Proxyfps");
+	inputs->enablePar("Proxyfps", half || quarter);
+
+	if(!_feed) {
+		destroyProxies();
+		return;
+	}
+
+	const int divisors[] = {2, 4};
+	const bool enabled[] = {half, quarter};
+	const char * suffixes[] = {" Half", " Quarter"};
+
+	std::vector<std::unique_ptr<Proxy>> proxies;
+	_proxiesError.clear();
+
+	for(int i = 0; i < 2; ++i) {
+		if(!enabled[i])
+			continue;
+
+		// Keep the running feed
+		auto existing = std::find_if(_proxies.begin(), _proxies.end(), [&](const std::unique_ptr<Proxy> &proxy) {
+			return proxy && proxy->divisor == divisors[i];
+		});
+
+		if(existing != _proxies.end()) {
+			proxies.push_back(std::move(*existing));
+			continue;
+		}
+
+		std::unique_ptr<Proxy> proxy(new Proxy());
+		proxy->name = _feedConfig.name + suffixes[i];
+		proxy->divisor = divisors[i];
+
+		if(!createExtraFeed(*proxy)) {
+			_proxiesError = "Could not create the NDI source " + proxy->name + ".";
+			continue;
+		}
+
+		proxies.push_back(std::move(proxy));
+	}
+
+	// End the feeds of disabled proxies
+	destroyProxies();
+	_proxies = std::move(proxies);
+}
+
+void NDIOutTOP::destroyProxies() {
+	for(const std::unique_ptr<Proxy> &proxy: _proxies) {
+		if(proxy)  // Not moved to the new proxies
+			destroyExtraFeed(*proxy);
+	}
+
+	_proxies.clear();
+}
+
+bool NDIOutTOP::areProxiesUnconnected() const {
+	for(const std::unique_ptr<Proxy> &proxy: _proxies) {
+		if(proxy->sender.getConnectionsCount() > 0)
+			return false;
+	}
+
+	return true;
+}
+
+bool NDIOutTOP::queueProxies(const uint8_t * pixels, int width, int height, const OP_TimeInfo * timeInfo) {
+	if(_proxies.empty())
+		return true;
+
+	// Reduced frame rate, same pacing as the tally throttling
+	if(_proxyFPS > 0) {
+		const double interval = std::max(1., timeInfo->rate / _proxyFPS);
+		const int64_t elapsed = timeInfo->absFrame - _proxyLastSentFrame;
+
+		if(elapsed >= 0 && elapsed + .5 < interval)
+			return false;
+	}
+
+	_proxyLastSentFrame = timeInfo->absFrame;
+
+	// Current level of the pyramid, starting from the input
+	const uint8_t * level = pixels;
+	int levelWidth = width;
+	int levelHeight = height;
+	int levelDivisor = 1;
+	size_t levelIndex = 0;
+
+	bool allQueued = true;
+
+	for(const std::unique_ptr<Proxy> &proxy: _proxies) {
+		if(_params.idleWhenUnconnected && proxy->sender.getConnectionsCount() == 0) {
+			allQueued = false;
+			continue;
+		}
+
+		// Go down the pyramid to the proxy resolution
+		while(levelDivisor < proxy->divisor && levelWidth >= 2 && levelHeight >= 2) {
+			if(_pyramidLevels.size() <= levelIndex)
+				_pyramidLevels.resize(levelIndex + 1);
+
+			std::vector<uint8_t> &buffer = _pyramidLevels[levelIndex++];
+			buffer.resize(static_cast<size_t>(levelWidth / 2) * (levelHeight / 2) * 4);
+
+			VideoScaler::halve(level, levelWidth * 4,
+							   levelWidth, levelHeight,
+							   buffer.data(), (levelWidth / 2) * 4,
+							   _pool.get());
+
+			level = buffer.data();
+			levelWidth /= 2;
+			levelHeight /= 2;
+			levelDivisor *= 2;
+		}
+
+		// Input too small for this proxy
+		if(levelDivisor != proxy->divisor)
+			continue;
+
+		const QueueResult result = queueFrame(proxy->sender,
+											  level, levelWidth * 4,
+											  levelWidth, levelHeight,
+											  _params.dedupe ? &proxy->lastHash : nullptr);
+
+		if(!handleQueueResult(result, proxy->sender, proxy->lastQueuedFrame, timeInfo))
+			allQueued = false;
+	}
+
+	return allQueued;
+}
+
+// MARK: - Extra feeds
+
+bool NDIOutTOP::createExtraFeed(ExtraFeed &feed) {
+	NDIlib_send_create_t settings;
+	settings.p_ndi_name = feed.name.c_str();
+	settings.p_groups = _feedConfig.groups.empty() ? nullptr : _feedConfig.groups.c_str();
+	settings.clock_video = false;
+	settings.clock_audio = false;
+
+	feed.feed = NDIlib_send_create(&settings);
+
+	if(!feed.feed)
+		return false;
+
+	feed.sender.start(feed.feed);
+	return true;
+}
+
+void NDIOutTOP::destroyExtraFeed(ExtraFeed &feed) {
+	feed.sender.stop();
+	NDIlib_send_destroy(feed.feed);
+	feed.feed = nullptr;
+}
+
+// MARK: - Playout
+
+void NDIOutTOP::updatePlayout(const OP_Inputs * inputs) {
+	const bool playout = _feed != nullptr && inputs->getParInt("Playout");
+	const std::string file = inputs->getParFilePath("Playoutfile");
+
+	_playoutLoop = inputs->getParInt("Playoutloop");
+	_playoutPrefetch = inputs->getParInt("Playoutprefetch");
+
+	inputs->enablePar("Playoutfile", inputs->getParInt("Playout"));
+	inputs->enablePar("Playoutloop", inputs->getParInt("Playout"));
+	inputs->enablePar("Playoutprefetch", inputs->getParInt("Playout"));
+
+	_params.playout = playout && !file.empty();
+
+	if(!_params.playout) {
+		stopPlayout();
+		_params.playoutFile = "";
+		_playoutError.clear();
+		return;
+	}
+
+	// Do not retry a file that could not be opened until it changes. A
+	// playout stopped without error, as when the feed was recreated, is
+	// started again.
+	if(file == _params.playoutFile && (_playoutThread.joinable() || !_playoutError.empty()))
+		return;
+
+	stopPlayout();
+	startPlayout(file);
+}
+
+void NDIOutTOP::startPlayout(const std::string &path) {
+	_params.playoutFile = path;
+
+	std::unique_ptr<RawVideoReader> reader(new RawVideoReader());
+
+	if(!reader->open(path)) {
+		_playoutError = reader->getError();
+		return;
+	}
+
+	if(reader->getFramesCount() == 0) {
+		_playoutError = path + " holds no frames.";
+		return;
+	}
+
+	_playoutError.clear();
+	_playoutReader = std::move(reader);
+	_playoutFrame = 0;
+	_playoutSentFrames = 0;
+	_playoutSkippedFrames = 0;
+	_playoutFinished = false;
+
+	_playingOut = true;
+	_playoutThread = std::thread(&NDIOutTOP::playoutLoop, this);
+}
+
+void NDIOutTOP::stopPlayout() {
+	if(_playoutThread.joinable()) {
+		{
+			std::unique_lock<std::mutex> lock(_playoutMutex);
+			_playingOut = false;
+		}
+
+		_playoutCondition.notify_all();
+		_playoutThread.join();
+	}
+
+	// The thread flushed the feed, nothing points to the mapping anymore
+	_playoutReader.reset();
+}
+
+/// Duration of a frame from its recorded frame rate, in 100 ns units
+static int64_t frameDuration(const RawVideoFile::FrameHeader &header) {
+	if(header.frameRateN == 0 || header.frameRateD == 0)
+		return 10000000 / 60;
+
+	return 10000000LL * header.frameRateD / header.frameRateN;
+}
+
+void NDIOutTOP::playoutLoop() {
+	using clock = std::chrono::steady_clock;
+
+	const RawVideoReader &reader = *_playoutReader;
+	const size_t framesCount = reader.getFramesCount();
+
+	NDIlib_video_frame_v2_t videoFrame;
+	videoFrame.picture_aspect_ratio = 0;
+	videoFrame.p_metadata = nullptr;
+
+	RawVideoReader::Frame frame;
+	reader.getFrame(0, frame);
+	reader.prefetch(0, _playoutPrefetch);
+
+	// Time of each frame from the first one, in 100 ns units
+	const clock::time_point start = clock::now();
+	int64_t position = 0;
+	size_t index = 0;
+
+	while(true) {
+		const int64_t timestamp = frame.header->timestamp;
+
+		// Wait for the frame to be due
+		const clock::time_point due = start + std::chrono::microseconds(position / 10);
+
+		{
+			std::unique_lock<std::mutex> lock(_playoutMutex);
+			_playoutCondition.wait_until(lock, due, [&] { return !_playingOut; });
+
+			if(!_playingOut)
+				break;
+		}
+
+		// Find the next frame and its time
+		const bool isLast = index + 1 == framesCount;
+		const size_t nextIndex = isLast ? 0 : index + 1;
+
+		RawVideoReader::Frame nextFrame;
+		reader.getFrame(nextIndex, nextFrame);
+
+		const int64_t nextTimestamp = nextFrame.header->timestamp;
+		int64_t delta = nextTimestamp - timestamp;
+
+		// Loop back, missing or broken timestamps: use the frame rate
+		if(isLast || timestamp == NDIlib_recv_timestamp_undefined || nextTimestamp == NDIlib_recv_timestamp_undefined || delta <= 0)
+			delta = frameDuration(*frame.header);
+
+		const int64_t nextPosition = position + delta;
+		const clock::time_point nextDue = start + std::chrono::microseconds(nextPosition / 10);
+
+		// Already late for the next one, skip this frame to catch up
+		if(clock::now() >= nextDue && !(isLast && !_playoutLoop)) {
+			++_playoutSkippedFrames;
+		} else {
+			videoFrame.xres = frame.header->width;
+			videoFrame.yres = frame.header->height;
+			videoFrame.FourCC = static_cast<NDIlib_FourCC_video_type_e>(frame.header->fourCC);
+			videoFrame.frame_rate_N = frame.header->frameRateN;
+			videoFrame.frame_rate_D = frame.header->frameRateD;
+			videoFrame.frame_format_type = static_cast<NDIlib_frame_format_type_e>(frame.header->frameFormatType);
+			videoFrame.line_stride_in_bytes = frame.header->stride;
+			videoFrame.timecode = NDIlib_send_timecode_synthesize;
+			videoFrame.p_data = const_cast<uint8_t *>(frame.data);
+
+			// NDI holds on the pages until the next send, the mapping
+			// outlives this thread
+			NDIlib_send_send_video_async_v2(_feed, &videoFrame);
+			++_playoutSentFrames;
+		}
+
+		_playoutFrame = index;
+
+		if(isLast && !_playoutLoop) {
+			_playoutFinished = true;
+			break;
+		}
+
+		// Read ahead of the playhead. A looping recording is read again,
+		// keep it cached then.
+		reader.prefetch(nextIndex + 1, _playoutPrefetch);
+
+		if(!_playoutLoop && index >= 2)
+			reader.release(index - 2, 1);
+
+		frame = nextFrame;
+		index = nextIndex;
+		position = nextPosition;
+	}
+
+	// Keep the last frame on air until the playout stops
+	std::unique_lock<std::mutex> lock(_playoutMutex);
+	_playoutCondition.wait(lock, [&] { return !_playingOut; });
+	lock.unlock();
 
-	return parGroups;
+	// Release the last frame before the mapping goes away
+	NDIlib_send_send_video_async_v2(_feed, nullptr);
 }
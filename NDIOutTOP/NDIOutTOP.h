@@ -8,8 +8,19 @@
 
 #include <string>
 #include <future>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "../third-parties/TOP_CPlusPlusBase.h"
+#include "../Utils/audio_sender.hpp"
+#include "../Utils/raw_video_reader.hpp"
+#include "../Utils/video_sender.hpp"
+#include "../Utils/video_scaler.hpp"
+#include "../Utils/worker_pool.hpp"
 
 #include <Processing.NDI.Lib.h>
 
@@ -32,24 +43,133 @@ public:
 	virtual void setupParameters(OP_ParameterManager *manager, void *reserved1) override;
 
 	virtual void getErrorString(OP_String *error, void *reserved1) override;
+	virtual void getWarningString(OP_String *warning, void *reserved1) override;
 
 private:
+	// First, see WorkerPool::acquire()
+	std::shared_ptr<WorkerPool> _pool = WorkerPool::acquire();
+
 	// Our sender
 	NDIlib_send_instance_t _feed = nullptr;
 
+	// Sends the frames copied by execute, off the cook thread
+	VideoSender _sender;
+
+	// Packetizes the audio CHOP and sends it, off the cook thread
+	AudioSender _audioSender;
+
+	enum class PreviewMode {
+		/// The output shows the input, at full resolution
+		Full,
+
+		/// The output shows a small version of the input
+		Thumbnail,
+
+		/// The output is a single black pixel
+		None
+	};
+
+	enum class SendFormat {
+		BGRA,
+
+		/// BGRA without alpha, lighter to encode
+		BGRX,
+
+		/// 4:2:2, converted on our side
+		UYVY,
+
+		/// UYVY followed by an alpha plane
+		UYVA,
+
+		/// 4:2:2 on 16 bits, from a 16 bits download
+		P216,
+
+		/// P216 followed by a 16 bits alpha plane
+		PA16
+	};
+
+	enum class QueueResult {
+		Queued,
+
+		/// Same pixels as the last queued frame, nothing was queued
+		Duplicate,
+
+		/// Every buffer was in use, nothing was queued
+		Dropped
+	};
+
+	/// Largest side of the thumbnail preview
+	static const int thumbnailSize = 256;
+
 	struct {
 		bool active;
 		std::string sourceName = "";
-		unsigned short fps = 60;
 
-		int64_t groupsCookCount = 0;
+		// Sent frame rate, as a fraction so NTSC rates are exact
+		int frameRateN = 60;
+		int frameRateD = 1;
+
+		// Send on a steady clock, repeating the last frame if no new one came
+		bool pacedSend = false;
+
+		// Let NDI pace the audio sends
+		bool clockAudio = false;
+
+		// Sample rate the audio is sent at, 0 to keep the CHOP one
+		int audioRate = 48000;
+		PreviewMode preview = PreviewMode::Full;
+		SendFormat sendFormat = SendFormat::BGRA;
+
+		// Skip the download and the send while no one is connected
+		bool idleWhenUnconnected = false;
+
+		// Send less when not on program: a fraction of the frames on
+		// preview, a few frames per second at a lower resolution otherwise
+		bool tallyThrottle = false;
+		double previewRate = .5;
+		double untalliedFPS = 1.;
+		int untalliedDivisor = 4;
+
+		// Do not send the same frame twice, but repeat it at least every
+		// maxHold seconds so receivers do not drop the source
+		bool dedupe = false;
+		double maxHold = 1.;
+
+		// Kept between cooks, the table is only read when it changes
+		int64_t groupsCookCount = -1;
 		std::string groupsDATPath = "";
 		std::string groups = "";
+
+		// Send a recording instead of the input
+		bool playout = false;
+		std::string playoutFile = "";  // Last file opened, or tried
 	} _params;
 
+	// Settings the feed was created with. NDI cannot change them on a
+	// running feed, it is only recreated when they really change. Every
+	// other parameter is applied live.
+	struct {
+		std::string name;
+		std::string groups;
+		bool clockAudio = false;
+	} _feedConfig;
+
 	NDIlib_send_create_t _feedSettings;
+	uint64_t _senderRecreations = 0;
 	NDIlib_metadata_frame_t _feedMetadata;
 
+	// The connection metadata is only sent again when its DAT changes, or
+	// to a new feed
+	std::string _metadataDATPath = "";
+	int64_t _metadataCookCount = -1;
+	bool _metadataDirty = true;
+
+	// Per-frame metadata, serialized once per cook then copied along each
+	// frame in the sender buffers
+	std::string _frameMetadata;
+	size_t _frameMetadataHash = 0;
+	size_t _settledMetadataHash = 0;
+
 	bool _isErrored = false;
 	std::string _errorMessage;
 
@@ -57,11 +177,206 @@ private:
 	
 	NDIlib_video_frame_v2_t _videoFrame;
 
-	NDIlib_audio_frame_v2_t _audioFrame;
+	// Timecode of this cook frames, in 100 ns units from the timeline start
+	int64_t _frameTimecode = 0;
+
+	std::vector<const float *> _audioChannels;
 
 	uint8_t* _dataBuffer = nullptr;
 
+	VideoScaler _previewScaler;
+
+	// The 16 bits download narrowed to BGRA, for the preview and every feed
+	// not sent on 16 bits
+	std::vector<uint8_t> _narrowBuffer;
+
+	// Tally throttling
+	int64_t _lastSentFrame = 0;
+	uint64_t _throttledFrames = 0;
+	VideoScaler _throttleScaler;
+	std::vector<uint8_t> _throttleBuffer;
+
+	// Work saved while no one was connected
+	bool _isIdle = false;
+	uint64_t _idleSkippedFrames = 0;
+	uint64_t _idleSavedBytes = 0;
+
+	// Identical frames detection. The download is delayed by one cook, so
+	// the input cook count only proves the frame unchanged once it has been
+	// stable for a cook and that frame went out.
+	int64_t _previousInputCooks = -1;
+	int64_t _settledInputCooks = -1;
+	int _settledDivisor = 1;
+	uint64_t _lastFrameHash = 0;
+	int64_t _lastQueuedFrame = 0;
+	uint64_t _unchangedCooks = 0;
+	uint64_t _duplicateFrames = 0;
+	uint64_t _heldFrames = 0;
+
+	/// Copies or converts a frame in a buffer of the sender following the
+	/// send format, then queues it. BGRA frames are sent with the 8 bits
+	/// counterpart of a 16 bits send format.
+	/// @param stride Size in bytes of a row of pixels
+	/// @param lastHash Hash of the last frame queued on this sender. If
+	/// given, the frame is only queued when its hash differs, and the hash
+	/// is updated.
+	/// @param pixelType Layout of the pixels. 16 bits RGBA frames must have
+	/// an even width and a 16 bits send format.
+	QueueResult queueFrame(VideoSender &sender, const uint8_t * pixels, int stride, int width, int height, uint64_t * lastHash = nullptr,
+						   OP_CPUMemPixelType pixelType = OP_CPUMemPixelType::BGRA8Fixed);
+
+	/// Handles a frame identical to the last one sent: skips it, or has the
+	/// sender repeat the last one if it has been held for too long
+	/// @param lastQueuedFrame Time of the last frame queued or repeated on
+	/// the sender, updated on repeat
+	void holdFrame(VideoSender &sender, int64_t &lastQueuedFrame, const OP_TimeInfo * timeInfo);
+
+	/// Updates the send statistics of a sender after queueFrame()
+	/// @returns False if the frame was dropped
+	bool handleQueueResult(QueueResult result, VideoSender &sender, int64_t &lastQueuedFrame, const OP_TimeInfo * timeInfo);
+
+	/// Forgets the last sent frame, the next one is always sent
+	void resetDedupe();
+
+	/// Paces every sender following the parameters
+	void updatePacing();
+
+	/// Sends the connection metadata if its DAT changed
+	void updateConnectionMetadata(const OP_Inputs * inputs);
+
+	/// Serializes the frame metadata DAT and CHOP in a single XML element
+	void updateFrameMetadata(const OP_Inputs * inputs);
+
+	// MARK: - Extra feeds
+
+	// A NDI source of its own, sent from the same download as the main feed
+	struct ExtraFeed {
+		/// Name of the NDI source
+		std::string name;
+
+		NDIlib_send_instance_t feed = nullptr;
+		VideoSender sender;
+
+		uint64_t lastHash = 0;
+		int64_t lastQueuedFrame = 0;
+	};
+
+	/// Creates the NDI source of the feed, with the main feed groups, and
+	/// starts its sender
+	/// @returns False if the source could not be created
+	bool createExtraFeed(ExtraFeed &feed);
+
+	/// Stops the sender of the feed and destroys its NDI source
+	void destroyExtraFeed(ExtraFeed &feed);
+
+	/// Tell if this cook's frame should be skipped following the tally
+	/// @param divisor Set to the resolution divisor to send with
+	bool isThrottled(const OP_TimeInfo * timeInfo, int &divisor);
+
+	/// Fills the output following the preview mode
+	/// @param inputPixels The BGRA frame. If null, the output is cleared.
+	void updatePreview(TOP_OutputFormatSpecs * output, const OP_TOPInput * inputTOP, const uint8_t * inputPixels);
+
+	// MARK: - Regions
+
+	// Parts of the input sent as their own NDI sources
+	struct Region : ExtraFeed {
+		/// In pixels, from the top-left corner of the sent image
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	std::vector<std::unique_ptr<Region>> _regions;
+
+	std::string _regionsDATPath = "";
+	int64_t _regionsCookCount = -1;
+	std::string _regionsError;
+
+	/// Reads the regions table, creating and destroying the regions feeds
+	/// as needed. Regions keep their feed as long as their name is unchanged.
+	void updateRegions(const OP_Inputs * inputs);
+
+	/// Stops and destroys every region feed
+	void destroyRegions();
+
+	/// Tell if every region feed is without receivers
+	bool areRegionsUnconnected() const;
+
+	/// Queues the part of the frame covered by each region on its sender
+	/// @returns False if a region did not get the frame
+	bool queueRegions(const uint8_t * pixels, int width, int height, const OP_TimeInfo * timeInfo);
+
+	// MARK: - Proxies
+
+	// The whole input at a fraction of its resolution, and optionally of
+	// its frame rate, for monitoring
+	struct Proxy : ExtraFeed {
+		/// 2 for half resolution, 4 for quarter
+		int divisor = 2;
+	};
+
+	// Ordered by divisor, each level of the pyramid is computed from the
+	// previous one
+	std::vector<std::unique_ptr<Proxy>> _proxies;
+	std::vector<std::vector<uint8_t>> _pyramidLevels;
+
+	double _proxyFPS = 0;
+	int64_t _proxyLastSentFrame = 0;
+	std::string _proxiesError;
+
+	/// Creates and destroys the proxies feeds following the parameters
+	void updateProxies(const OP_Inputs * inputs);
+
+	/// Stops and destroys every proxy feed
+	void destroyProxies();
+
+	/// Tell if every proxy feed is without receivers
+	bool areProxiesUnconnected() const;
+
+	/// Downscales the frame and queues it on each proxy sender
+	/// @returns False if a proxy did not get the frame
+	bool queueProxies(const uint8_t * pixels, int width, int height, const OP_TimeInfo * timeInfo);
+
+	// MARK: - Playout
+
+	// A recording sent straight from its mapped pages by the playout thread,
+	// at the pace it was recorded
+	std::unique_ptr<RawVideoReader> _playoutReader;
+	std::thread _playoutThread;
+	bool _playingOut = false;
+	std::mutex _playoutMutex;
+	std::condition_variable _playoutCondition;
+
+	std::atomic<bool> _playoutLoop = {true};
+	std::atomic<int> _playoutPrefetch = {8};
+
+	std::atomic<uint64_t> _playoutFrame = {0};
+	std::atomic<uint64_t> _playoutSentFrames = {0};
+	std::atomic<uint64_t> _playoutSkippedFrames = {0};
+	std::atomic<bool> _playoutFinished = {false};
+
+	std::string _playoutError;
+
+	/// Starts or stops the playout following the parameters
+	void updatePlayout(const OP_Inputs * inputs);
+
+	/// Opens the recording and starts the playout thread on the current feed
+	void startPlayout(const std::string &path);
+
+	/// Stops the playout thread and closes the recording. Must be called
+	/// before destroying the feed.
+	void stopPlayout();
+
+	/// Sends the recording frames, sleeping until each one is due
+	void playoutLoop();
+
 	// MARK: - Validations & updates
 
-	std::string getGroups(const OP_Inputs* inputs);
+	/// Reads the groups table into the parameters if it changed
+	void updateGroups(const OP_Inputs* inputs);
+
+	/// Tell if the feed has to be recreated to follow the parameters
+	bool needsRecreation() const;
 };
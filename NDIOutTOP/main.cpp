@@ -31,8 +31,8 @@ DLLEXPORT void FillTOPPluginInfo(TOP_PluginInfo *info) {
 	info->customOPInfo.authorName->setString("Valentin Dufois");
 	info->customOPInfo.authorEmail->setString("valentin@dufois.fr");
 
-	// This TOP works with 1 input connected
-	info->customOPInfo.minInputs = 1;
+	// This TOP works with 1 input connected, none when playing out a recording
+	info->customOPInfo.minInputs = 0;
 	info->customOPInfo.maxInputs = 1;
 }
 
@@ -0,0 +1,133 @@
+//
+//  audio_resampler.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "audio_resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <immintrin.h>
+
+/// Sum of the products of tapsCount samples and coefficients
+template<int tapsCount>
+static inline float dotProduct(const float * samples, const float * coefficients) {
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+
+	for(int i = 0; i < tapsCount; i += 8) {
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coefficients + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(coefficients + i + 4)));
+	}
+
+	__m128 sum4 = _mm_add_ps(sum0, sum1);
+	sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+	sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+	return _mm_cvtss_f32(sum4);
+}
+
+void AudioResampler::configure(int channelsCount, int inputRate, int outputRate) {
+	if(channelsCount == _channelsCount && inputRate == _inputRate && outputRate == _outputRate)
+		return;
+
+	_channelsCount = channelsCount;
+	_inputRate = inputRate;
+	_outputRate = outputRate;
+
+	int64_t divisor = inputRate;
+
+	for(int64_t remainder = outputRate; remainder != 0;)
+		divisor = std::exchange(remainder, divisor % remainder);
+
+	_up = outputRate / divisor;
+	_down = inputRate / divisor;
+	_phasesCount = static_cast<int>(std::min<int64_t>(_up, maxPhasesCount));
+
+	// Windowed sinc, cut below the lowest Nyquist frequency
+	const double pi = 3.14159265358979323846;
+	const double cutoff = std::min(1., static_cast<double>(outputRate) / inputRate) * .95;
+	const int center = tapsCount / 2 - 1;
+
+	_coefficients.resize(static_cast<size_t>(_phasesCount) * tapsCount);
+
+	for(int p = 0; p < _phasesCount; ++p) {
+		float * phase = _coefficients.data() + p * tapsCount;
+		const double fraction = static_cast<double>(p) / _phasesCount;
+		double sum = 0;
+
+		for(int k = 0; k < tapsCount; ++k) {
+			const double u = k - center - fraction;
+			const double x = pi * cutoff * u;
+			const double sinc = x == 0 ? 1. : std::sin(x) / x;
+
+			// Blackman window over the taps span
+			const double w = pi * u / (tapsCount / 2);
+			const double window = std::abs(u) >= tapsCount / 2 ? 0. : .42 + .5 * std::cos(w) + .08 * std::cos(2 * w);
+
+			phase[k] = static_cast<float>(sinc * window);
+			sum += phase[k];
+		}
+
+		// Unity gain on every phase
+		for(int k = 0; k < tapsCount; ++k)
+			phase[k] = static_cast<float>(phase[k] / sum);
+	}
+
+	reset();
+}
+
+void AudioResampler::reset() {
+	_history.resize(_channelsCount);
+
+	// The first output sample is centered on the first input sample
+	for(std::vector<float> &history: _history)
+		history.assign(tapsCount / 2 - 1, 0.f);
+
+	_position = 0;
+	_phase = 0;
+}
+
+int AudioResampler::process(const float * const * input, int inputCount, std::vector<float> &output) {
+	for(int c = 0; c < _channelsCount; ++c)
+		_history[c].insert(_history[c].end(), input[c], input[c] + inputCount);
+
+	const int historySize = static_cast<int>(_history[0].size());
+
+	// Walk the output samples once for all channels
+	_steps.clear();
+
+	while(_position + tapsCount <= historySize) {
+		const int phaseIndex = static_cast<int>(_phase * _phasesCount / _up);
+		_steps.emplace_back(_position, phaseIndex * tapsCount);
+
+		_phase += _down;
+		_position += static_cast<int>(_phase / _up);
+		_phase %= _up;
+	}
+
+	const int outputCount = static_cast<int>(_steps.size());
+	output.resize(static_cast<size_t>(_channelsCount) * outputCount);
+
+	for(int c = 0; c < _channelsCount; ++c) {
+		const float * samples = _history[c].data();
+		float * channelOutput = output.data() + static_cast<size_t>(c) * outputCount;
+
+		for(int i = 0; i < outputCount; ++i)
+			channelOutput[i] = dotProduct<tapsCount>(samples + _steps[i].first, _coefficients.data() + _steps[i].second);
+	}
+
+	// Keep what the next output samples need
+	const int consumed = std::min(_position, historySize);
+
+	for(std::vector<float> &history: _history)
+		history.erase(history.begin(), history.begin() + consumed);
+
+	_position -= consumed;
+
+	return outputCount;
+}
@@ -0,0 +1,74 @@
+//
+//  audio_resampler.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef audio_resampler_hpp
+#define audio_resampler_hpp
+
+#include <cstdint>
+#include <vector>
+
+/// Converts planar float audio from one sample rate to another with a
+/// polyphase windowed-sinc filter.
+///
+/// The rates ratio is reduced to up/down integers and followed exactly, so
+/// the output never drifts. The last input samples are kept between blocks:
+/// successive calls to process() give the same result as a single one.
+class AudioResampler
+{
+public:
+	/// Prepares the filter for the given format. Does nothing if it did not
+	/// change, resets the state otherwise.
+	void configure(int channelsCount, int inputRate, int outputRate);
+
+	/// Forgets the previous input samples
+	void reset();
+
+	/// Resamples a block of samples
+	/// @param input One pointer per channel to its samples
+	/// @param inputCount Number of samples in each channel
+	/// @param output Filled with the resampled audio, channel after channel
+	/// @returns The number of output samples in each channel
+	int process(const float * const * input, int inputCount, std::vector<float> &output);
+
+	inline int getInputRate() const { return _inputRate; }
+	inline int getOutputRate() const { return _outputRate; }
+
+private:
+	/// Filter length, in input samples
+	static const int tapsCount = 32;
+
+	/// Rates with a larger up factor use the nearest of this many phases
+	static const int maxPhasesCount = 1024;
+
+	int _channelsCount = 0;
+	int _inputRate = 0;
+	int _outputRate = 0;
+
+	// Output time advances by _down / _up input samples per output sample
+	int64_t _up = 1;
+	int64_t _down = 1;
+	int _phasesCount = 1;
+
+	/// tapsCount coefficients per phase
+	std::vector<float> _coefficients;
+
+	/// Per channel, input samples not consumed yet, preceded by the filter
+	/// history
+	std::vector<std::vector<float>> _history;
+
+	/// Position of the next output sample in the history: first tap index
+	/// and phase, in 1 / _up of input sample
+	int _position = 0;
+	int64_t _phase = 0;
+
+	/// First tap and coefficients of each output sample of a block, shared
+	/// by all channels
+	std::vector<std::pair<int, int>> _steps;
+};
+
+#endif /* audio_resampler_hpp */
@@ -0,0 +1,206 @@
+//
+//  audio_sender.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "audio_sender.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+AudioSender::~AudioSender() {
+	stop();
+}
+
+void AudioSender::start(NDIlib_send_instance_t feed) {
+	if(_thread.joinable())
+		return;
+
+	_feed = feed;
+	_stopping = false;
+	_thread = std::thread(&AudioSender::sendLoop, this);
+}
+
+void AudioSender::stop() {
+	if(!_thread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_condition.notify_all();
+	_thread.join();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while(!_queuedPackets.empty()) {
+		_freePackets.push_back(std::move(_queuedPackets.front()));
+		_queuedPackets.pop_front();
+	}
+
+	if(_packet)
+		_freePackets.push_back(std::move(_packet));
+
+	// The next feed starts a new stream
+	_feed = nullptr;
+	_channelsCount = 0;
+	_resampler.reset();
+}
+
+void AudioSender::push(const float * const * channels, int channelsCount, int samplesCount,
+					   int sampleRate, int sendRate, int packetSize, int64_t timecode) {
+	if(channelsCount <= 0 || samplesCount <= 0 || sampleRate <= 0 || sendRate <= 0 || packetSize <= 0)
+		return;
+
+	// Convert to the send rate. The resampler keeps the end of the block
+	// for the next one, boundaries are seamless.
+	if(sendRate != sampleRate) {
+		_resampler.configure(channelsCount, sampleRate, sendRate);
+		samplesCount = _resampler.process(channels, samplesCount, _resampled);
+
+		_resampledChannels.resize(channelsCount);
+
+		for(int c = 0; c < channelsCount; ++c)
+			_resampledChannels[c] = _resampled.data() + static_cast<size_t>(c) * samplesCount;
+
+		channels = _resampledChannels.data();
+		sampleRate = sendRate;
+
+		if(samplesCount == 0)
+			return;
+	}
+
+	if(channelsCount != _channelsCount || sampleRate != _sampleRate || packetSize != _packetSize) {
+		restart(channelsCount, sampleRate, packetSize, timecode);
+	} else if(std::llabs(timecodeAt(_samplesCount) - timecode) > maxDrift) {
+		// The caller timecode jitters with the cooks and is only used as a
+		// reference, unless it jumped
+		++_discontinuitiesCount;
+		restart(channelsCount, sampleRate, packetSize, timecode);
+	}
+
+	int offset = 0;
+
+	while(offset < samplesCount) {
+		if(!_packet) {
+			_packet = acquire();
+			_packet->timecode = timecodeAt(_samplesCount);
+			_filled = 0;
+		}
+
+		const int count = std::min(samplesCount - offset, _packetSize - _filled);
+
+		// Channels are not guaranteed to be contiguous, copy them one by one
+		for(int c = 0; c < _channelsCount; ++c) {
+			memcpy(_packet->samples.data() + c * _packetSize + _filled,
+				   channels[c] + offset,
+				   count * sizeof(float));
+		}
+
+		_filled += count;
+		offset += count;
+		_samplesCount += count;
+
+		if(_filled == _packetSize)
+			queue(std::move(_packet));
+	}
+}
+
+int64_t AudioSender::timecodeAt(int64_t sample) const {
+	return _anchor + sample * 10000000LL / _sampleRate;
+}
+
+void AudioSender::restart(int channelsCount, int sampleRate, int packetSize, int64_t timecode) {
+	_channelsCount = channelsCount;
+	_sampleRate = sampleRate;
+	_packetSize = packetSize;
+	_anchor = timecode;
+	_samplesCount = 0;
+
+	if(_packet) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_freePackets.push_back(std::move(_packet));
+	}
+}
+
+std::unique_ptr<AudioSender::Packet> AudioSender::acquire() {
+	std::unique_ptr<Packet> packet;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if(!_freePackets.empty()) {
+			packet = std::move(_freePackets.back());
+			_freePackets.pop_back();
+		}
+	}
+
+	if(!packet)
+		packet.reset(new Packet());
+
+	// Keeps its capacity, no allocation once the pool is warm
+	packet->samples.resize(static_cast<size_t>(_channelsCount) * _packetSize);
+	packet->channelsCount = _channelsCount;
+	packet->samplesCount = _packetSize;
+	packet->sampleRate = _sampleRate;
+
+	return packet;
+}
+
+void AudioSender::queue(std::unique_ptr<Packet> packet) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		// The sender thread fell behind, drop the oldest audio
+		if(_queuedPackets.size() >= maxQueuedPackets) {
+			_freePackets.push_back(std::move(_queuedPackets.front()));
+			_queuedPackets.pop_front();
+			++_droppedCount;
+		}
+
+		_queuedPackets.push_back(std::move(packet));
+	}
+
+	_condition.notify_one();
+}
+
+void AudioSender::sendLoop() {
+	NDIlib_audio_frame_v2_t frame;
+	frame.p_metadata = nullptr;
+
+	while(true) {
+		std::unique_ptr<Packet> packet;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [&] { return _stopping || !_queuedPackets.empty(); });
+
+			if(_stopping)
+				break;
+
+			packet = std::move(_queuedPackets.front());
+			_queuedPackets.pop_front();
+		}
+
+		frame.sample_rate = packet->sampleRate;
+		frame.no_channels = packet->channelsCount;
+		frame.no_samples = packet->samplesCount;
+		frame.timecode = packet->timecode;
+		frame.channel_stride_in_bytes = packet->samplesCount * static_cast<int>(sizeof(float));
+		frame.p_data = packet->samples.data();
+
+		// Blocks until the packet is due if the feed clocks the audio. The
+		// SDK copies the samples.
+		NDIlib_send_send_audio_v2(_feed, &frame);
+		++_sentCount;
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_freePackets.push_back(std::move(packet));
+	}
+}
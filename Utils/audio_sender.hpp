@@ -0,0 +1,138 @@
+//
+//  audio_sender.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef audio_sender_hpp
+#define audio_sender_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Processing.NDI.Lib.h>
+
+#include "audio_resampler.hpp"
+
+/// Sends audio to a NDI feed from a dedicated thread, in packets of a fixed
+/// number of samples whatever the size of the blocks given by the caller.
+///
+/// Samples are gathered channel by channel in planar packets taken from a
+/// pool. Timecodes, in 100 ns units, follow from the number of samples sent
+/// since the stream started, anchored on the caller timecode. The stream is
+/// anchored again when its format changes or when the caller timecode drifts
+/// too far away.
+///
+/// Audio can be converted to a fixed send rate on the way, so receivers
+/// never have to resample it.
+///
+/// Sending from our own thread lets the feed clock the audio: the SDK then
+/// blocks each send until the packet is due, which must not happen on the
+/// cook thread.
+class AudioSender
+{
+public:
+	AudioSender() = default;
+	~AudioSender();
+
+	AudioSender(const AudioSender &) = delete;
+	AudioSender &operator=(const AudioSender &) = delete;
+
+	/// Starts the sender thread on the given feed
+	/// Does nothing if the thread is already running
+	void start(NDIlib_send_instance_t feed);
+
+	/// Stops the sender thread. Packets not sent yet are dropped. Must be
+	/// called before destroying the feed.
+	void stop();
+
+	inline bool isRunning() const { return _thread.joinable(); }
+
+	/// Appends a block of samples to the stream, queueing the packets it
+	/// completes
+	/// @param channels One pointer per channel to its samples
+	/// @param channelsCount Number of channels
+	/// @param samplesCount Number of samples in each channel
+	/// @param sampleRate Sample rate of the block
+	/// @param sendRate Sample rate to send at, resampling the block if it
+	/// differs
+	/// @param packetSize Number of samples in each sent packet, at the send
+	/// rate
+	/// @param timecode Time of the first sample of the block, in 100 ns units
+	void push(const float * const * channels, int channelsCount, int samplesCount,
+			  int sampleRate, int sendRate, int packetSize, int64_t timecode);
+
+	inline uint64_t getSentCount() const { return _sentCount; }
+	inline uint64_t getDroppedCount() const { return _droppedCount; }
+	inline uint64_t getDiscontinuitiesCount() const { return _discontinuitiesCount; }
+
+private:
+	/// Planar samples, channel after channel
+	struct Packet {
+		std::vector<float> samples;
+		int channelsCount = 0;
+		int samplesCount = 0;
+		int sampleRate = 0;
+		int64_t timecode = 0;
+	};
+
+	/// About half a second of audio at usual packet sizes
+	static const size_t maxQueuedPackets = 32;
+
+	/// Drift between the stream and the caller timecodes before anchoring
+	/// the stream again, in 100 ns units
+	static const int64_t maxDrift = 1000000;
+
+	NDIlib_send_instance_t _feed = nullptr;
+
+	std::thread _thread;
+	bool _stopping = false;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	std::vector<std::unique_ptr<Packet>> _freePackets;
+	std::deque<std::unique_ptr<Packet>> _queuedPackets;
+
+	// Stream state, only touched by the caller
+	std::unique_ptr<Packet> _packet;
+	int _filled = 0;
+	int _channelsCount = 0;
+	int _sampleRate = 0;
+	int _packetSize = 0;
+	int64_t _anchor = 0;
+	int64_t _samplesCount = 0;
+
+	// Conversion to the send rate, only touched by the caller
+	AudioResampler _resampler;
+	std::vector<float> _resampled;
+	std::vector<const float *> _resampledChannels;
+
+	std::atomic<uint64_t> _sentCount = {0};
+	std::atomic<uint64_t> _droppedCount = {0};
+	std::atomic<uint64_t> _discontinuitiesCount = {0};
+
+	/// Time of the given sample of the stream
+	int64_t timecodeAt(int64_t sample) const;
+
+	/// Restarts the stream, dropping the partial packet
+	void restart(int channelsCount, int sampleRate, int packetSize, int64_t timecode);
+
+	/// Gives a packet sized for the current stream
+	std::unique_ptr<Packet> acquire();
+
+	/// Queues the full packet for the sender thread
+	void queue(std::unique_ptr<Packet> packet);
+
+	void sendLoop();
+};
+
+#endif /* audio_sender_hpp */
@@ -0,0 +1,41 @@
+//
+//  clock_mapper.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "clock_mapper.hpp"
+
+#include <chrono>
+
+ClockMapper::ClockMapper(int64_t window):
+_window(window) {}
+
+int64_t ClockMapper::map(int64_t remoteTime, int64_t localTime) {
+	const int64_t offset = localTime - remoteTime;
+
+	// Monotonic deque: a new sample makes every larger one useless
+	while(!_samples.empty() && _samples.back().offset >= offset) {
+		_samples.pop_back();
+	}
+
+	_samples.push_back({localTime, offset});
+
+	// Slide the window
+	while(_samples.front().localTime < localTime - _window) {
+		_samples.pop_front();
+	}
+
+	return remoteTime + _samples.front().offset;
+}
+
+void ClockMapper::reset() {
+	_samples.clear();
+}
+
+int64_t ClockMapper::now() {
+	using namespace std::chrono;
+	return duration_cast<duration<int64_t, std::ratio<1, 10000000>>>(steady_clock::now().time_since_epoch()).count();
+}
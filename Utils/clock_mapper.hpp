@@ -0,0 +1,55 @@
+//
+//  clock_mapper.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef clock_mapper_hpp
+#define clock_mapper_hpp
+
+#include <cstdint>
+#include <deque>
+
+/// Maps timestamps from a remote clock, such as the one of an NDI sender, to
+/// the local clock.
+///
+/// The offset between the two clocks is the smallest transit delay observed
+/// over a sliding window: network and scheduling jitter only ever delay a
+/// frame, so the minimum is the closest estimate of the true offset, and
+/// the window lets it follow a slow drift between the clocks.
+class ClockMapper
+{
+public:
+	/// @param window Duration of the sliding window, in 100 ns units
+	explicit ClockMapper(int64_t window = 20000000);
+
+	/// Adds an observation and maps the remote time to the local clock
+	/// @param remoteTime The remote timestamp, in 100 ns units
+	/// @param localTime When it was received, on the local clock
+	/// @returns The remote time on the local clock
+	int64_t map(int64_t remoteTime, int64_t localTime);
+
+	/// Forgets all observations
+	void reset();
+
+	/// Tell the current offset between the two clocks
+	inline int64_t getOffset() const { return _samples.empty() ? 0 : _samples.front().offset; }
+
+	/// The local clock, in 100 ns units
+	static int64_t now();
+
+private:
+	struct Sample {
+		int64_t localTime;
+		int64_t offset;
+	};
+
+	int64_t _window;
+
+	// Candidates for the window minimum, in increasing offset order
+	std::deque<Sample> _samples;
+};
+
+#endif /* clock_mapper_hpp */
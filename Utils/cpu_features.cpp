@@ -0,0 +1,70 @@
+//
+//  cpu_features.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "cpu_features.hpp"
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void cpuid(int leaf, uint32_t registers[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int values[4];
+	__cpuidex(values, leaf, 0);
+
+	for(int i = 0; i < 4; ++i)
+		registers[i] = static_cast<uint32_t>(values[i]);
+#else
+	registers[0] = registers[1] = registers[2] = registers[3] = 0;
+	__get_cpuid_count(leaf, 0, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+}
+
+/// Tell if the OS saves the AVX registers on context switches
+static bool hasAVXState() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	const uint64_t enabled = _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	const uint64_t enabled = (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+
+	// XMM and YMM states
+	return (enabled & 0x6) == 0x6;
+}
+
+static bool detectAVX2() {
+	uint32_t registers[4];
+	cpuid(0, registers);
+
+	if(registers[0] < 7)
+		return false;
+
+	// OSXSAVE and AVX
+	cpuid(1, registers);
+
+	if((registers[2] & (1u << 27)) == 0 || (registers[2] & (1u << 28)) == 0)
+		return false;
+
+	if(!hasAVXState())
+		return false;
+
+	cpuid(7, registers);
+	return (registers[1] & (1u << 5)) != 0;
+}
+
+bool CPUFeatures::hasAVX2() {
+	static const bool supported = detectAVX2();
+	return supported;
+}
@@ -0,0 +1,29 @@
+//
+//  cpu_features.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef cpu_features_hpp
+#define cpu_features_hpp
+
+/// Compiles a function for AVX2 whatever the target of the build, so it can
+/// be picked at runtime. MSVC accepts AVX2 intrinsics anywhere.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+/// Instruction sets available on the running CPU, for the kernels built
+/// beyond the baseline of the build
+class CPUFeatures
+{
+public:
+	/// Tell if the CPU and the OS support AVX2. Checked once.
+	static bool hasAVX2();
+};
+
+#endif /* cpu_features_hpp */
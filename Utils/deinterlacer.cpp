@@ -0,0 +1,189 @@
+//
+//  deinterlacer.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "deinterlacer.hpp"
+#include "worker_pool.hpp"
+#include "fast_memcpy.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <immintrin.h>
+
+void Deinterlacer::pushField(const uint8_t * src, int srcStride,
+							 int width, int lines, int parity,
+							 WorkerPool * pool) {
+	// A change of format invalidates the history
+	if(width != _width || lines * 2 != _frameHeight)
+		reset();
+
+	_width = width;
+	_frameHeight = lines * 2;
+
+	_latest = (_latest + 1) % 3;
+	_count = std::min(_count + 1, 3);
+
+	Field &field = _fields[_latest];
+	field.data.resize(width * lines * 4);
+	field.lines = lines;
+	field.parity = parity;
+
+	const int rowBytes = width * 4;
+	uint8_t * dst = field.data.data();
+
+	auto copyLines = [&](int begin, int end) {
+		for(int i = begin; i < end; ++i) {
+			memcpy_fast(dst + i * rowBytes, src + i * srcStride, rowBytes);
+		}
+	};
+
+	if(pool)
+		pool->parallelFor(lines, copyLines);
+	else
+		copyLines(0, lines);
+}
+
+void Deinterlacer::render(Mode mode, uint8_t * dst, int dstStride,
+						  int rowBegin, int rowEnd,
+						  WorkerPool * pool) const {
+	if(_count == 0)
+		return;
+
+	rowEnd = std::min(rowEnd, _frameHeight);
+
+	if(pool == nullptr) {
+		renderRows(mode, dst, dstStride, rowBegin, rowBegin, rowEnd);
+		return;
+	}
+
+	pool->parallelFor(rowEnd - rowBegin, [&](int begin, int end) {
+		renderRows(mode, dst, dstStride, rowBegin, rowBegin + begin, rowBegin + end);
+	});
+}
+
+void Deinterlacer::reset() {
+	_count = 0;
+	_width = 0;
+	_frameHeight = 0;
+}
+
+// MARK: - Kernels
+
+/// Tell the line of a field holding the given frame row, clamped to the
+/// lines of the field
+static inline int fieldLine(int row, int parity, int lines) {
+	return std::max(0, std::min((row - parity) / 2, lines - 1));
+}
+
+/// Per pixel motion mask: all bits set for pixels where any channel of the
+/// two pairs differs by more than the threshold
+static inline __m128i motionMask(__m128i a0, __m128i b0, __m128i a1, __m128i b1, __m128i threshold) {
+	const __m128i diff0 = _mm_or_si128(_mm_subs_epu8(a0, b0), _mm_subs_epu8(b0, a0));
+	const __m128i diff1 = _mm_or_si128(_mm_subs_epu8(a1, b1), _mm_subs_epu8(b1, a1));
+	__m128i diff = _mm_max_epu8(diff0, diff1);
+
+	// Gather the largest channel difference in the low byte of each pixel
+	diff = _mm_max_epu8(diff, _mm_srli_epi32(diff, 8));
+	diff = _mm_max_epu8(diff, _mm_srli_epi32(diff, 16));
+	diff = _mm_and_si128(diff, _mm_set1_epi32(0xFF));
+
+	return _mm_cmpgt_epi32(diff, threshold);
+}
+
+void Deinterlacer::renderRows(Mode mode, uint8_t * dst, int dstStride,
+							  int firstRow, int rowBegin, int rowEnd) const {
+	const Field * current = getField(0);
+	const Field * previous = getField(1);
+	const Field * beforePrevious = getField(2);
+
+	// Weaving needs the opposite field, motion detection the one before
+	if(previous == nullptr || previous->parity == current->parity) {
+		mode = Mode::Bob;
+	} else if(mode == Mode::MotionAdaptive &&
+			  (beforePrevious == nullptr || beforePrevious->parity != current->parity)) {
+		mode = Mode::Bob;
+	}
+
+	const int rowBytes = _width * 4;
+	const int parity = current->parity;
+	const __m128i threshold = _mm_set1_epi32(_motionThreshold);
+
+	for(int row = rowBegin; row < rowEnd; ++row) {
+		uint8_t * dstRow = dst + (row - firstRow) * dstStride;
+
+		// Lines of the latest field are kept as is
+		if((row & 1) == parity) {
+			memcpy_fast(dstRow, current->data.data() + fieldLine(row, parity, current->lines) * rowBytes, rowBytes);
+			continue;
+		}
+
+		if(mode == Mode::Weave) {
+			memcpy_fast(dstRow, previous->data.data() + fieldLine(row, 1 - parity, previous->lines) * rowBytes, rowBytes);
+			continue;
+		}
+
+		// Lines above and below the missing one, from the latest field
+		const int aboveLine = fieldLine(row - 1, parity, current->lines);
+		const int belowLine = fieldLine(row + 1, parity, current->lines);
+		const uint8_t * above = current->data.data() + aboveLine * rowBytes;
+		const uint8_t * below = current->data.data() + belowLine * rowBytes;
+
+		if(mode == Mode::Bob) {
+			int i = 0;
+
+			for(; i + 16 <= rowBytes; i += 16) {
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(below + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + i), _mm_avg_epu8(a, b));
+			}
+
+			for(; i < rowBytes; ++i) {
+				dstRow[i] = static_cast<uint8_t>((above[i] + below[i] + 1) >> 1);
+			}
+
+			continue;
+		}
+
+		// Motion adaptive
+		const uint8_t * woven = previous->data.data() + fieldLine(row, 1 - parity, previous->lines) * rowBytes;
+		const uint8_t * pastAbove = beforePrevious->data.data() + aboveLine * rowBytes;
+		const uint8_t * pastBelow = beforePrevious->data.data() + belowLine * rowBytes;
+
+		int i = 0;
+
+		for(; i + 16 <= rowBytes; i += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(below + i));
+			const __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pastAbove + i));
+			const __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pastBelow + i));
+			const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(woven + i));
+
+			const __m128i mask = motionMask(a, pa, b, pb, threshold);
+			const __m128i bob = _mm_avg_epu8(a, b);
+			const __m128i result = _mm_or_si128(_mm_and_si128(mask, bob), _mm_andnot_si128(mask, w));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + i), result);
+		}
+
+		// Remaining pixels
+		for(; i < rowBytes; i += 4) {
+			int motion = 0;
+
+			for(int c = 0; c < 4; ++c) {
+				motion = std::max(motion, std::abs(above[i + c] - pastAbove[i + c]));
+				motion = std::max(motion, std::abs(below[i + c] - pastBelow[i + c]));
+			}
+
+			for(int c = 0; c < 4; ++c) {
+				dstRow[i + c] = motion > _motionThreshold ?
+					static_cast<uint8_t>((above[i + c] + below[i + c] + 1) >> 1) :
+					woven[i + c];
+			}
+		}
+	}
+}
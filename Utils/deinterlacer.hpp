@@ -0,0 +1,101 @@
+//
+//  deinterlacer.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef deinterlacer_hpp
+#define deinterlacer_hpp
+
+#include <cstdint>
+#include <vector>
+
+class WorkerPool;
+
+/// Rebuilds progressive 8 bits BGRA frames from a sequence of fields.
+/// Fields are pushed as they are received, and each one can then be
+/// rendered as a full frame.
+class Deinterlacer
+{
+public:
+	enum class Mode {
+		/// Interleaves the latest field with the previous one. Full
+		/// vertical resolution, combing on motion.
+		Weave,
+
+		/// Interpolates the missing lines from the latest field alone.
+		/// No combing, half the vertical resolution.
+		Bob,
+
+		/// Weaves still areas and bobs moving ones, detecting motion by
+		/// comparing the latest field with the previous one of the same
+		/// parity.
+		MotionAdaptive
+	};
+
+	/// Stores a field, dropping the oldest one.
+	/// @param src First line of the field
+	/// @param srcStride Size in bytes between two lines of the field
+	/// @param width Width of the field in pixels
+	/// @param lines Number of lines in the field
+	/// @param parity 0 if the field holds the even lines of the frame (top
+	/// field), 1 for the odd lines
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	void pushField(const uint8_t * src, int srcStride,
+				   int width, int lines, int parity,
+				   WorkerPool * pool);
+
+	/// Renders rows of the frame rebuilt around the latest field.
+	/// @param dst Where to write the first rendered row
+	/// @param dstStride Size in bytes between two rendered rows
+	/// @param rowBegin First frame row to render
+	/// @param rowEnd Frame row after the last one to render
+	void render(Mode mode, uint8_t * dst, int dstStride,
+				int rowBegin, int rowEnd,
+				WorkerPool * pool) const;
+
+	/// Forgets all stored fields
+	void reset();
+
+	/// Threshold above which a pixel difference is considered motion in
+	/// the MotionAdaptive mode.
+	inline void setMotionThreshold(uint8_t threshold) { _motionThreshold = threshold; }
+
+	inline int getWidth() const { return _width; }
+
+	/// Tell the height of the frames rebuilt from the stored fields
+	inline int getFrameHeight() const { return _frameHeight; }
+
+	/// Tell if a field is available for rendering
+	inline bool hasField() const { return _count > 0; }
+
+private:
+	struct Field {
+		std::vector<uint8_t> data;
+		int lines = 0;
+		int parity = 0;
+	};
+
+	// The three latest fields, _latest being the most recent one
+	Field _fields[3];
+	int _latest = 0;
+	int _count = 0;
+
+	int _width = 0;
+	int _frameHeight = 0;
+
+	uint8_t _motionThreshold = 12;
+
+	/// Gives the field pushed the given number of fields ago
+	inline const Field * getField(int age) const {
+		return age < _count ? &_fields[(_latest + 3 - age) % 3] : nullptr;
+	}
+
+	/// Renders the frame rows [rowBegin, rowEnd), dst pointing to the row
+	/// firstRow
+	void renderRows(Mode mode, uint8_t * dst, int dstStride, int firstRow, int rowBegin, int rowEnd) const;
+};
+
+#endif /* deinterlacer_hpp */
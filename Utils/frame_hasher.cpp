@@ -0,0 +1,107 @@
+//
+//  frame_hasher.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "frame_hasher.hpp"
+#include "hash_mix.hpp"
+#include "worker_pool.hpp"
+
+#include <atomic>
+
+#include <immintrin.h>
+
+namespace {
+
+using HashMix::mixBits;
+using HashMix::mixBlock;
+
+/// Hashes a range of rows, copying them if a destination is given. Rows
+/// hashes are summed, so ranges can be merged in any order.
+template<bool copy>
+uint64_t processRows(uint8_t * dst, int dstStride,
+					 const uint8_t * src, int srcStride,
+					 int rowBytes, int rowBegin, int rowEnd) {
+	alignas(16) uint64_t lanes[4];
+	uint64_t hash = 0;
+
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * srcRow = src + y * srcStride;
+		uint8_t * dstRow = copy ? dst + y * dstStride : nullptr;
+
+		// Two independent chains keep the loads flowing
+		__m128i hashA = _mm_set1_epi32(y + 1);
+		__m128i hashB = _mm_set1_epi32(~(y + 1));
+
+		int x = 0;
+
+		for(; x + 32 <= rowBytes; x += 32) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + x));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + x + 16));
+
+			if(copy) {
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + x), a);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + x + 16), b);
+			}
+
+			hashA = mixBlock(hashA, a);
+			hashB = mixBlock(hashB, b);
+		}
+
+		uint64_t tailHash = 0;
+
+		for(; x < rowBytes; ++x) {
+			if(copy)
+				dstRow[x] = srcRow[x];
+
+			tailHash = tailHash * 31 + srcRow[x];
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes), hashA);
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes + 2), hashB);
+		hash += mixBits(lanes[0] ^ mixBits(lanes[1] ^ mixBits(lanes[2] ^ mixBits(lanes[3] ^ tailHash ^ static_cast<uint64_t>(y)))));
+	}
+
+	return hash;
+}
+
+template<bool copy>
+uint64_t process(uint8_t * dst, int dstStride,
+				 const uint8_t * src, int srcStride,
+				 int rowBytes, int rows,
+				 WorkerPool * pool) {
+	uint64_t hash;
+
+	if(pool == nullptr) {
+		hash = processRows<copy>(dst, dstStride, src, srcStride, rowBytes, 0, rows);
+	} else {
+		std::atomic<uint64_t> sum = {0};
+
+		pool->parallelFor(rows, [&](int begin, int end) {
+			sum += processRows<copy>(dst, dstStride, src, srcStride, rowBytes, begin, end);
+		});
+
+		hash = sum;
+	}
+
+	// Frames of different sizes never match
+	return mixBits(hash ^ (static_cast<uint64_t>(rowBytes) << 32 | static_cast<uint32_t>(rows)));
+}
+
+}  // namespace
+
+uint64_t FrameHasher::hash(const uint8_t * src, int srcStride,
+						   int rowBytes, int rows,
+						   WorkerPool * pool) {
+	return process<false>(nullptr, 0, src, srcStride, rowBytes, rows, pool);
+}
+
+uint64_t FrameHasher::copyAndHash(uint8_t * dst, int dstStride,
+								  const uint8_t * src, int srcStride,
+								  int rowBytes, int rows,
+								  WorkerPool * pool) {
+	return process<true>(dst, dstStride, src, srcStride, rowBytes, rows, pool);
+}
@@ -0,0 +1,41 @@
+//
+//  frame_hasher.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef frame_hasher_hpp
+#define frame_hasher_hpp
+
+#include <cstdint>
+
+class WorkerPool;
+
+/// Computes 64 bits hashes of frames to tell identical ones apart, either on
+/// their own or while copying them, so the pixels are only read once.
+class FrameHasher
+{
+public:
+	/// Hashes a frame, splitting rows over the given pool
+	/// @param src The pixels
+	/// @param srcStride Size in bytes of a row
+	/// @param rowBytes Number of bytes to hash in each row
+	/// @param rows Number of rows
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	static uint64_t hash(const uint8_t * src, int srcStride,
+						 int rowBytes, int rows,
+						 WorkerPool * pool);
+
+	/// Copies a frame and hashes it on the way, splitting rows over the
+	/// given pool. Gives the same hash as hash().
+	/// @param dst Where to copy the pixels
+	/// @param dstStride Size in bytes of a destination row
+	static uint64_t copyAndHash(uint8_t * dst, int dstStride,
+								const uint8_t * src, int srcStride,
+								int rowBytes, int rows,
+								WorkerPool * pool);
+};
+
+#endif /* frame_hasher_hpp */
@@ -0,0 +1,163 @@
+//
+//  frame_queue.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "frame_queue.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+FrameQueue::FrameQueue(size_t capacity):
+_capacity(capacity) {}
+
+std::unique_ptr<VideoFrame> FrameQueue::acquire() {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	if(_recycled.empty())
+		return std::unique_ptr<VideoFrame>(new VideoFrame());
+
+	std::unique_ptr<VideoFrame> frame = std::move(_recycled.back());
+	_recycled.pop_back();
+	return frame;
+}
+
+void FrameQueue::setCapacity(size_t capacity) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_capacity = std::max<size_t>(1, capacity);
+
+	while(_queue.size() > _capacity) {
+		recycleLocked(std::move(_queue.front()));
+		_queue.pop_front();
+		++_droppedCount;
+	}
+
+	// Free the buffers the smaller queue will not need
+	if(_recycled.size() > _capacity)
+		_recycled.resize(_capacity);
+}
+
+void FrameQueue::push(std::unique_ptr<VideoFrame> frame) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while(_queue.size() >= _capacity) {
+		recycleLocked(std::move(_queue.front()));
+		_queue.pop_front();
+		++_droppedCount;
+	}
+
+	_queue.push_back(std::move(frame));
+}
+
+std::unique_ptr<VideoFrame> FrameQueue::popLatest(int64_t time) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	std::unique_ptr<VideoFrame> frame;
+
+	while(!_queue.empty() && _queue.front()->presentationTime <= time) {
+		if(frame) {
+			recycleLocked(std::move(frame));
+			++_droppedCount;
+		}
+
+		frame = std::move(_queue.front());
+		_queue.pop_front();
+	}
+
+	return frame;
+}
+
+std::unique_ptr<VideoFrame> FrameQueue::popNearest(int64_t time, int64_t currentTime) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// Frames are queued in presentation order, stop as soon as they get further
+	int64_t bestDistance = std::abs(currentTime - time);
+	size_t bestIndex = _queue.size();
+
+	for(size_t i = 0; i < _queue.size(); ++i) {
+		const int64_t distance = std::abs(_queue[i]->presentationTime - time);
+
+		if(distance >= bestDistance)
+			break;
+
+		bestDistance = distance;
+		bestIndex = i;
+	}
+
+	if(bestIndex == _queue.size())
+		return nullptr;
+
+	for(size_t i = 0; i < bestIndex; ++i) {
+		recycleLocked(std::move(_queue.front()));
+		_queue.pop_front();
+		++_droppedCount;
+	}
+
+	std::unique_ptr<VideoFrame> frame = std::move(_queue.front());
+	_queue.pop_front();
+	return frame;
+}
+
+void FrameQueue::getKeys(std::vector<int64_t> &keys, bool timecode) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	keys.clear();
+
+	for(const std::unique_ptr<VideoFrame> &frame: _queue)
+		keys.push_back(timecode ? frame->timecode : frame->timestamp);
+}
+
+std::unique_ptr<VideoFrame> FrameQueue::popMatching(int64_t key, int64_t tolerance, bool timecode) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	size_t index = 0;
+
+	while(index < _queue.size() &&
+		  std::abs((timecode ? _queue[index]->timecode : _queue[index]->timestamp) - key) > tolerance)
+		++index;
+
+	if(index == _queue.size())
+		return nullptr;
+
+	for(size_t i = 0; i < index; ++i) {
+		recycleLocked(std::move(_queue.front()));
+		_queue.pop_front();
+		++_droppedCount;
+	}
+
+	std::unique_ptr<VideoFrame> frame = std::move(_queue.front());
+	_queue.pop_front();
+	return frame;
+}
+
+void FrameQueue::recycle(std::unique_ptr<VideoFrame> frame) {
+	if(!frame)
+		return;
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	recycleLocked(std::move(frame));
+}
+
+void FrameQueue::clear() {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while(!_queue.empty()) {
+		recycleLocked(std::move(_queue.front()));
+		_queue.pop_front();
+	}
+}
+
+void FrameQueue::recycleLocked(std::unique_ptr<VideoFrame> frame) {
+	// More would only pin memory, let it go
+	if(_recycled.size() < _capacity)
+		_recycled.push_back(std::move(frame));
+}
+
+size_t FrameQueue::size() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _queue.size();
+}
@@ -0,0 +1,115 @@
+//
+//  frame_queue.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef frame_queue_hpp
+#define frame_queue_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// An 8 bits BGRA frame, ready to be handed to TouchDesigner
+struct VideoFrame {
+	std::vector<uint8_t> data;
+
+	int width = 0;
+	int height = 0;
+
+	// Size of the frame as sent, before cropping and scaling
+	int sourceWidth = 0;
+	int sourceHeight = 0;
+
+	int frameRateN = 0;
+	int frameRateD = 1;
+
+	/// NDI timestamp of the frame, in 100 ns units
+	int64_t timestamp = 0;
+
+	/// Timecode given by the sender, in 100 ns units
+	int64_t timecode = 0;
+
+	/// When the frame should be shown, on the local clock, in 100 ns units
+	int64_t presentationTime = 0;
+};
+
+/// Hands frames from a producer thread to a consumer thread. Frames buffers
+/// are recycled to avoid allocating on every frame.
+class FrameQueue
+{
+public:
+	/// @param capacity Maximum number of frames waiting in the queue. The
+	/// oldest frame is dropped when pushing to a full queue.
+	explicit FrameQueue(size_t capacity);
+
+	/// Changes the maximum number of frames waiting in the queue. The oldest
+	/// frames are dropped if the queue holds more, and recycled buffers
+	/// above the new capacity are freed.
+	void setCapacity(size_t capacity);
+
+	inline size_t getCapacity() const { return _capacity; }
+
+	/// Gives a frame to fill, reusing a recycled buffer when possible
+	std::unique_ptr<VideoFrame> acquire();
+
+	/// Queues a filled frame
+	void push(std::unique_ptr<VideoFrame> frame);
+
+	/// Takes the newest frame presented at or before the given time out of
+	/// the queue. Older frames are dropped.
+	/// @returns The frame, or null if no frame is due yet
+	std::unique_ptr<VideoFrame> popLatest(int64_t time = std::numeric_limits<int64_t>::max());
+
+	/// Takes the frame presented closest to the given time out of the queue,
+	/// if it is closer than the frame currently shown. Older frames are
+	/// dropped, newer ones stay queued.
+	/// @param time The time to match
+	/// @param currentTime Presentation time of the frame currently shown
+	/// @returns The frame, or null if the current one is still the best match
+	std::unique_ptr<VideoFrame> popNearest(int64_t time, int64_t currentTime);
+
+	/// Lists the timestamps, or timecodes, of the queued frames, oldest first
+	void getKeys(std::vector<int64_t> &keys, bool timecode);
+
+	/// Takes the oldest frame whose timestamp, or timecode, is within the
+	/// tolerance of the given key out of the queue. Frames queued before it
+	/// are dropped.
+	/// @returns The frame, or null if no queued frame matches
+	std::unique_ptr<VideoFrame> popMatching(int64_t key, int64_t tolerance, bool timecode);
+
+	/// Gives back a frame taken out of the queue so its buffer can be reused
+	void recycle(std::unique_ptr<VideoFrame> frame);
+
+	/// Drops all queued frames
+	void clear();
+
+	/// Tell how many frames are waiting
+	size_t size();
+
+	/// Tell how many frames were dropped without being popped
+	inline uint64_t getDroppedCount() const { return _droppedCount; }
+
+private:
+	size_t _capacity;
+
+	std::deque<std::unique_ptr<VideoFrame>> _queue;
+	std::vector<std::unique_ptr<VideoFrame>> _recycled;
+
+	std::mutex _mutex;
+
+	std::atomic<uint64_t> _droppedCount = {0};
+
+	/// Keeps the buffer of the frame for reuse, up to the capacity of the
+	/// queue. The mutex must be held.
+	void recycleLocked(std::unique_ptr<VideoFrame> frame);
+};
+
+#endif /* frame_queue_hpp */
@@ -0,0 +1,38 @@
+//
+//  hash_mix.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef hash_mix_hpp
+#define hash_mix_hpp
+
+#include <cstdint>
+
+#include <immintrin.h>
+
+/// Mixing steps of the pixels hashes, shared by the frozen picture detection
+/// and the frames dedupe so both hash the same way
+namespace HashMix {
+
+/// Spreads the bits of a 64 bits value (splitmix64 finalizer)
+inline uint64_t mixBits(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/// Rotate-add-xor, any changed byte changes the rest of the row hash
+inline __m128i mixBlock(__m128i hash, __m128i block) {
+	const __m128i rotated = _mm_or_si128(_mm_slli_epi32(hash, 7), _mm_srli_epi32(hash, 25));
+	return _mm_xor_si128(_mm_add_epi32(hash, block), rotated);
+}
+
+}  // namespace HashMix
+
+#endif /* hash_mix_hpp */
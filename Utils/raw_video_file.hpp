@@ -0,0 +1,85 @@
+//
+//  raw_video_file.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef raw_video_file_hpp
+#define raw_video_file_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+/// Layout of the raw video recordings. Everything is stored in blocks so
+/// files can be written without the system cache and frames memory-mapped
+/// back straight from their pages:
+///
+///     [FileHeader, padded to a block]
+///     [FrameHeader, padded to a block][pixels, padded to a block]
+///     ...
+///     [IndexEntry * framesCount, padded to a block]
+///
+/// The index is written when closing the file. A file without index,
+/// after a crash, can be rebuilt by walking the frame headers.
+namespace RawVideoFile {
+
+/// Alignment of every part of the file, in bytes
+static const size_t blockSize = 4096;
+
+static const uint32_t version = 1;
+
+/// "NDIRAWV1", little-endian
+static const uint64_t fileMagic = 0x315657415249444EULL;
+
+/// "FRME", little-endian
+static const uint32_t frameMagic = 0x454d5246;
+
+struct FileHeader {
+	uint64_t magic = fileMagic;
+	uint32_t version = RawVideoFile::version;
+	uint32_t reserved = 0;
+
+	/// Written when closing, 0 while recording
+	uint64_t framesCount = 0;
+	uint64_t indexOffset = 0;
+};
+
+struct FrameHeader {
+	uint32_t magic = frameMagic;
+
+	/// NDI FourCC of the pixels, and frame format type (progressive,
+	/// interleaved or single field)
+	uint32_t fourCC = 0;
+	uint32_t frameFormatType = 0;
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t stride = 0;
+
+	uint32_t frameRateN = 0;
+	uint32_t frameRateD = 1;
+
+	/// NDI timestamp and timecode, in 100 ns units
+	int64_t timestamp = 0;
+	int64_t timecode = 0;
+
+	/// Size of the pixels, before padding
+	uint64_t dataSize = 0;
+};
+
+struct IndexEntry {
+	/// Offset of the frame header in the file. Pixels start one block later.
+	uint64_t offset = 0;
+	int64_t timestamp = 0;
+};
+
+/// Rounds a size up to a whole number of blocks
+inline size_t alignToBlock(size_t size) {
+	return (size + blockSize - 1) / blockSize * blockSize;
+}
+
+}  // namespace RawVideoFile
+
+#endif /* raw_video_file_hpp */
@@ -0,0 +1,271 @@
+//
+//  raw_video_reader.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "raw_video_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+RawVideoReader::~RawVideoReader() {
+	close();
+}
+
+bool RawVideoReader::open(const std::string &path) {
+	close();
+	_error.clear();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if(file == INVALID_HANDLE_VALUE) {
+		_error = "Could not open " + path + ".";
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	_size = static_cast<uint64_t>(size.QuadPart);
+
+	HANDLE mapping = _size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	void * map = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	_file = file;
+	_mapping = mapping;
+
+	if(map == nullptr) {
+		_error = "Could not map " + path + ".";
+		close();
+		return false;
+	}
+
+	_map = static_cast<uint8_t *>(map);
+#else
+	const int file = ::open(path.c_str(), O_RDONLY);
+
+	if(file < 0) {
+		_error = "Could not open " + path + ": " + strerror(errno) + ".";
+		return false;
+	}
+
+	struct stat status;
+	fstat(file, &status);
+	_size = static_cast<uint64_t>(status.st_size);
+
+	void * map = _size > 0 ? mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+
+	// The mapping keeps the file alive
+	::close(file);
+
+	if(map == MAP_FAILED) {
+		_error = "Could not map " + path + ".";
+		return false;
+	}
+
+	_map = static_cast<uint8_t *>(map);
+
+	// Played from start to end
+	madvise(_map, _size, MADV_SEQUENTIAL);
+#endif
+
+	RawVideoFile::FileHeader header;
+
+	if(_size >= RawVideoFile::blockSize)
+		memcpy(&header, _map, sizeof(header));
+
+	if(_size < RawVideoFile::blockSize || header.magic != RawVideoFile::fileMagic) {
+		_error = path + " is not a raw video recording.";
+		close();
+		return false;
+	}
+
+	if(!loadIndex(header))
+		rebuildIndex();
+
+	return true;
+}
+
+void RawVideoReader::close() {
+#ifdef _WIN32
+	if(_map != nullptr)
+		UnmapViewOfFile(_map);
+
+	if(_mapping != nullptr)
+		CloseHandle(static_cast<HANDLE>(_mapping));
+
+	if(_file != nullptr)
+		CloseHandle(static_cast<HANDLE>(_file));
+
+	_mapping = nullptr;
+	_file = nullptr;
+#else
+	if(_map != nullptr)
+		munmap(_map, _size);
+#endif
+
+	_map = nullptr;
+	_size = 0;
+	_index.clear();
+}
+
+bool RawVideoReader::getFrame(size_t index, Frame &frame) const {
+	if(index >= _index.size())
+		return false;
+
+	const uint64_t offset = _index[index].offset;
+
+	frame.header = reinterpret_cast<const RawVideoFile::FrameHeader *>(_map + offset);
+	frame.data = _map + offset + RawVideoFile::blockSize;
+	return true;
+}
+
+void RawVideoReader::prefetch(size_t first, size_t count) const {
+	uint8_t * begin;
+	size_t length;
+
+	if(!getPagesRange(first, count, begin, length))
+		return;
+
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = begin;
+	range.NumberOfBytes = length;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise(begin, length, MADV_WILLNEED);
+#endif
+}
+
+void RawVideoReader::release(size_t first, size_t count) const {
+	uint8_t * begin;
+	size_t length;
+
+	if(!getPagesRange(first, count, begin, length))
+		return;
+
+#ifdef _WIN32
+	// Clean file-backed pages are trimmed by the system as needed
+	(void)begin;
+	(void)length;
+#else
+	madvise(begin, length, MADV_DONTNEED);
+#endif
+}
+
+bool RawVideoReader::loadIndex(const RawVideoFile::FileHeader &header) {
+	if(header.indexOffset < RawVideoFile::blockSize || header.indexOffset > _size)
+		return false;
+
+	// Compared by count so a corrupted count cannot overflow the size
+	const uint64_t maxFramesCount = (_size - header.indexOffset) / sizeof(RawVideoFile::IndexEntry);
+
+	if(header.framesCount > maxFramesCount)
+		return false;
+
+	std::vector<RawVideoFile::IndexEntry> index(static_cast<size_t>(header.framesCount));
+	memcpy(index.data(), _map + header.indexOffset, index.size() * sizeof(RawVideoFile::IndexEntry));
+
+	// Every frame is read straight from the mapping, they must all be in it
+	uint64_t end;
+
+	for(const RawVideoFile::IndexEntry &entry: index) {
+		if(!getFrameEnd(entry.offset, end))
+			return false;
+	}
+
+	_index = std::move(index);
+	return true;
+}
+
+void RawVideoReader::rebuildIndex() {
+	_index.clear();
+
+	uint64_t offset = RawVideoFile::blockSize;
+	uint64_t end;
+
+	// Stop at the first incomplete frame
+	while(getFrameEnd(offset, end)) {
+		RawVideoFile::FrameHeader header;
+		memcpy(&header, _map + offset, sizeof(header));
+
+		RawVideoFile::IndexEntry entry;
+		entry.offset = offset;
+		entry.timestamp = header.timestamp;
+		_index.push_back(entry);
+
+		offset = end;
+	}
+}
+
+bool RawVideoReader::getFrameEnd(uint64_t offset, uint64_t &end) const {
+	if(offset < RawVideoFile::blockSize || offset % RawVideoFile::blockSize != 0 ||
+	   offset > _size - RawVideoFile::blockSize)
+		return false;
+
+	RawVideoFile::FrameHeader header;
+	memcpy(&header, _map + offset, sizeof(header));
+
+	if(header.magic != RawVideoFile::frameMagic)
+		return false;
+
+	// The pixels must hold every line sent. Single fields
+	// (NDIlib_frame_format_type_field_0 and _1) hold half of them.
+	const bool isField = header.frameFormatType == 2 || header.frameFormatType == 3;
+	const uint64_t lines = isField ? header.height / 2 : header.height;
+
+	if(static_cast<uint64_t>(header.stride) * lines > header.dataSize)
+		return false;
+
+	// Checked before padding so a corrupted size cannot overflow
+	const uint64_t available = _size - offset - RawVideoFile::blockSize;
+
+	if(header.dataSize > available || RawVideoFile::alignToBlock(header.dataSize) > available)
+		return false;
+
+	end = offset + RawVideoFile::blockSize + RawVideoFile::alignToBlock(header.dataSize);
+	return true;
+}
+
+bool RawVideoReader::getPagesRange(size_t first, size_t count, uint8_t * &begin, size_t &length) const {
+	if(first >= _index.size() || count == 0)
+		return false;
+
+	const size_t last = std::min(first + count, _index.size()) - 1;
+
+	RawVideoFile::FrameHeader lastHeader;
+	memcpy(&lastHeader, _map + _index[last].offset, sizeof(lastHeader));
+
+	const uint64_t rangeBegin = _index[first].offset;
+	const uint64_t rangeEnd = _index[last].offset + RawVideoFile::blockSize + RawVideoFile::alignToBlock(lastHeader.dataSize);
+
+	// Pages may be larger than our blocks
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	const uint64_t pageSize = systemInfo.dwPageSize;
+#else
+	const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+	const uint64_t alignedBegin = rangeBegin / pageSize * pageSize;
+
+	begin = _map + alignedBegin;
+	length = static_cast<size_t>(std::min(rangeEnd, _size) - alignedBegin);
+	return true;
+}
@@ -0,0 +1,88 @@
+//
+//  raw_video_reader.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef raw_video_reader_hpp
+#define raw_video_reader_hpp
+
+#include "raw_video_file.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Memory-maps a raw video file written by RawVideoWriter. Frames are read
+/// straight from the mapped pages, without copy.
+class RawVideoReader
+{
+public:
+	struct Frame {
+		const RawVideoFile::FrameHeader * header = nullptr;
+		const uint8_t * data = nullptr;
+	};
+
+	RawVideoReader() = default;
+	~RawVideoReader();
+
+	RawVideoReader(const RawVideoReader &) = delete;
+	RawVideoReader &operator=(const RawVideoReader &) = delete;
+
+	/// Maps the file and loads its index, rebuilding it from the frames
+	/// headers if the recording was not closed properly
+	/// @returns False if the file could not be read, see getError()
+	bool open(const std::string &path);
+
+	void close();
+
+	inline bool isOpen() const { return _map != nullptr; }
+
+	inline size_t getFramesCount() const { return _index.size(); }
+
+	/// Gives the header and pixels of a frame
+	/// @returns False if the index is out of range
+	bool getFrame(size_t index, Frame &frame) const;
+
+	/// Asks the system to start reading the given frames from disk
+	void prefetch(size_t first, size_t count) const;
+
+	/// Tells the system the given frames will not be needed soon, so their
+	/// pages can be reclaimed
+	void release(size_t first, size_t count) const;
+
+	inline const std::string &getError() const { return _error; }
+
+private:
+	uint8_t * _map = nullptr;
+	uint64_t _size = 0;
+
+	std::vector<RawVideoFile::IndexEntry> _index;
+
+	std::string _error;
+
+#ifdef _WIN32
+	void * _file = nullptr;
+	void * _mapping = nullptr;
+#endif
+
+	/// Loads the index written when closing the recording
+	/// @returns False if it is missing or points outside of the file
+	bool loadIndex(const RawVideoFile::FileHeader &header);
+
+	/// Walks the frames headers to list the frames
+	void rebuildIndex();
+
+	/// Checks the frame at the given offset lies within the file
+	/// @param end Receives the offset following the frame
+	/// @returns False if the frame is invalid or truncated
+	bool getFrameEnd(uint64_t offset, uint64_t &end) const;
+
+	/// Computes the page-aligned range covering the given frames
+	/// @returns False if the range is empty
+	bool getPagesRange(size_t first, size_t count, uint8_t * &begin, size_t &length) const;
+};
+
+#endif /* raw_video_reader_hpp */
@@ -0,0 +1,323 @@
+//
+//  raw_video_writer.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "raw_video_writer.hpp"
+#include "fast_memcpy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+// MARK: - Buffer
+
+RawVideoWriter::Buffer::~Buffer() {
+#ifdef _WIN32
+	_aligned_free(data);
+#else
+	free(data);
+#endif
+}
+
+void RawVideoWriter::Buffer::reserve(size_t requestedSize) {
+	if(requestedSize <= capacity)
+		return;
+
+#ifdef _WIN32
+	_aligned_free(data);
+	data = static_cast<uint8_t *>(_aligned_malloc(requestedSize, RawVideoFile::blockSize));
+#else
+	free(data);
+
+	void * memory = nullptr;
+	data = posix_memalign(&memory, RawVideoFile::blockSize, requestedSize) == 0 ? static_cast<uint8_t *>(memory) : nullptr;
+#endif
+
+	if(data == nullptr)
+		throw std::bad_alloc();
+
+	capacity = requestedSize;
+}
+
+// MARK: - Writer
+
+RawVideoWriter::RawVideoWriter(size_t queueCapacity):
+_queueCapacity(std::max<size_t>(queueCapacity, 1)) {}
+
+RawVideoWriter::~RawVideoWriter() {
+	close();
+}
+
+bool RawVideoWriter::open(const std::string &path) {
+	close();
+
+	{
+		std::unique_lock<std::mutex> lock(_errorMutex);
+		_error.clear();
+	}
+
+	_index.clear();
+	_writeOffset = RawVideoFile::blockSize;
+	_failed = false;
+	_writtenCount = 0;
+	_droppedCount = 0;
+	_bytesWritten = 0;
+
+#ifdef _WIN32
+	// Unbuffered writes, straight from our aligned buffers to the disk
+	HANDLE file = CreateFileA(path.c_str(),
+							  GENERIC_WRITE, FILE_SHARE_READ,
+							  nullptr, CREATE_ALWAYS,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN,
+							  nullptr);
+
+	if(file == INVALID_HANDLE_VALUE) {
+		setError("Could not create " + path + ".");
+		return false;
+	}
+
+	_file = file;
+#else
+#ifdef __linux__
+	// Bypass the page cache. Some file systems refuse it.
+	_file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+
+	if(_file < 0 && errno == EINVAL)
+		_file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#else
+	_file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+
+	if(_file < 0) {
+		setError("Could not create " + path + ": " + strerror(errno) + ".");
+		return false;
+	}
+
+#ifdef __APPLE__
+	fcntl(_file, F_NOCACHE, 1);
+#endif
+#endif
+
+	// Placeholder header, completed when closing
+	Buffer header;
+	header.reserve(RawVideoFile::blockSize);
+	memset(header.data, 0, RawVideoFile::blockSize);
+
+	const RawVideoFile::FileHeader fileHeader;
+	memcpy(header.data, &fileHeader, sizeof(fileHeader));
+
+	writeAt(0, header.data, RawVideoFile::blockSize);
+
+	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+		_stopping = false;
+	}
+
+	_isOpen = true;
+	_writerThread = std::thread(&RawVideoWriter::writerLoop, this);
+
+	return true;
+}
+
+void RawVideoWriter::close() {
+	if(!_writerThread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+		_stopping = true;
+	}
+
+	_isOpen = false;
+	_queueCondition.notify_all();
+	_writerThread.join();
+
+	finalize();
+
+#ifdef _WIN32
+	CloseHandle(static_cast<HANDLE>(_file));
+	_file = nullptr;
+#else
+	::close(_file);
+	_file = -1;
+#endif
+}
+
+bool RawVideoWriter::push(const RawVideoFile::FrameHeader &header, const uint8_t * data) {
+	if(!_isOpen)
+		return false;
+
+	std::unique_ptr<Buffer> buffer;
+
+	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+
+		if(!_freeBuffers.empty()) {
+			buffer = std::move(_freeBuffers.back());
+			_freeBuffers.pop_back();
+		} else if(_buffersCount < _queueCapacity) {
+			buffer.reset(new Buffer());
+			++_buffersCount;
+		} else {
+			// Every buffer waits for the disk
+			++_droppedCount;
+			return false;
+		}
+	}
+
+	// Header block, then the pixels padded to a block
+	const size_t dataSize = static_cast<size_t>(header.dataSize);
+	buffer->size = RawVideoFile::blockSize + RawVideoFile::alignToBlock(dataSize);
+	buffer->reserve(buffer->size);
+
+	memset(buffer->data, 0, RawVideoFile::blockSize);
+	memcpy(buffer->data, &header, sizeof(header));
+	memcpy_fast(buffer->data + RawVideoFile::blockSize, data, dataSize);
+	memset(buffer->data + RawVideoFile::blockSize + dataSize, 0, buffer->size - RawVideoFile::blockSize - dataSize);
+
+	{
+		std::unique_lock<std::mutex> lock(_queueMutex);
+
+		// Closed while copying
+		if(_stopping) {
+			_freeBuffers.push_back(std::move(buffer));
+			return false;
+		}
+
+		_queue.push_back(std::move(buffer));
+	}
+
+	_queueCondition.notify_one();
+	return true;
+}
+
+size_t RawVideoWriter::getQueueSize() {
+	std::unique_lock<std::mutex> lock(_queueMutex);
+	return _queue.size();
+}
+
+std::string RawVideoWriter::getError() {
+	std::unique_lock<std::mutex> lock(_errorMutex);
+	return _error;
+}
+
+void RawVideoWriter::writerLoop() {
+	while(true) {
+		std::unique_ptr<Buffer> buffer;
+
+		{
+			std::unique_lock<std::mutex> lock(_queueMutex);
+			_queueCondition.wait(lock, [&] { return _stopping || !_queue.empty(); });
+
+			// Flush everything before stopping
+			if(_queue.empty())
+				return;
+
+			buffer = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		RawVideoFile::FrameHeader header;
+		memcpy(&header, buffer->data, sizeof(header));
+
+		if(!_failed && writeAt(_writeOffset, buffer->data, buffer->size)) {
+			RawVideoFile::IndexEntry entry;
+			entry.offset = _writeOffset;
+			entry.timestamp = header.timestamp;
+			_index.push_back(entry);
+
+			_writeOffset += buffer->size;
+			_bytesWritten += buffer->size;
+			++_writtenCount;
+		} else {
+			++_droppedCount;
+		}
+
+		std::unique_lock<std::mutex> lock(_queueMutex);
+		_freeBuffers.push_back(std::move(buffer));
+	}
+}
+
+void RawVideoWriter::finalize() {
+	if(_failed)
+		return;
+
+	const size_t indexSize = _index.size() * sizeof(RawVideoFile::IndexEntry);
+
+	Buffer block;
+	block.reserve(std::max(RawVideoFile::alignToBlock(indexSize), RawVideoFile::blockSize));
+	memset(block.data, 0, block.capacity);
+
+	if(indexSize > 0) {
+		memcpy(block.data, _index.data(), indexSize);
+
+		if(!writeAt(_writeOffset, block.data, RawVideoFile::alignToBlock(indexSize)))
+			return;
+	}
+
+	RawVideoFile::FileHeader fileHeader;
+	fileHeader.framesCount = _index.size();
+	fileHeader.indexOffset = indexSize > 0 ? _writeOffset : 0;
+
+	memset(block.data, 0, RawVideoFile::blockSize);
+	memcpy(block.data, &fileHeader, sizeof(fileHeader));
+	writeAt(0, block.data, RawVideoFile::blockSize);
+}
+
+bool RawVideoWriter::writeAt(uint64_t offset, const uint8_t * data, size_t size) {
+	while(size > 0) {
+#ifdef _WIN32
+		// WriteFile takes 32 bits sizes, write by whole blocks
+		const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1 << 30));
+
+		OVERLAPPED position = {};
+		position.Offset = static_cast<DWORD>(offset);
+		position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD written = 0;
+
+		if(!WriteFile(static_cast<HANDLE>(_file), data, chunk, &written, &position) || written == 0) {
+			setError("Could not write to the recording (error " + std::to_string(GetLastError()) + ").");
+			return false;
+		}
+#else
+		const ssize_t written = pwrite(_file, data, size, static_cast<off_t>(offset));
+
+		if(written < 0 && errno == EINTR)
+			continue;
+
+		if(written <= 0) {
+			setError(std::string("Could not write to the recording: ") + strerror(errno) + ".");
+			return false;
+		}
+#endif
+
+		data += written;
+		size -= written;
+		offset += written;
+	}
+
+	return true;
+}
+
+void RawVideoWriter::setError(const std::string &error) {
+	_failed = true;
+
+	std::unique_lock<std::mutex> lock(_errorMutex);
+	_error = error;
+}
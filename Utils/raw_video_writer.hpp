@@ -0,0 +1,121 @@
+//
+//  raw_video_writer.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef raw_video_writer_hpp
+#define raw_video_writer_hpp
+
+#include "raw_video_file.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Streams frames to a raw video file from a background thread. Frames are
+/// copied into a bounded pool of block-aligned buffers and written with
+/// large sequential unbuffered writes. When the disk falls behind and every
+/// buffer is waiting, new frames are dropped instead of blocking the caller.
+class RawVideoWriter
+{
+public:
+	/// @param queueCapacity Number of frames that may wait for the disk
+	explicit RawVideoWriter(size_t queueCapacity = 16);
+	~RawVideoWriter();
+
+	RawVideoWriter(const RawVideoWriter &) = delete;
+	RawVideoWriter &operator=(const RawVideoWriter &) = delete;
+
+	/// Creates the file and starts the writer thread
+	/// @returns False if the file could not be created, see getError()
+	bool open(const std::string &path);
+
+	/// Writes the queued frames and the index, then closes the file. Blocks
+	/// until the queue is flushed.
+	void close();
+
+	/// Queues a frame for writing
+	/// @param header Description of the frame, dataSize being the number of
+	/// bytes to read from data
+	/// @param data The pixels
+	/// @returns False if the frame was dropped
+	bool push(const RawVideoFile::FrameHeader &header, const uint8_t * data);
+
+	inline bool isOpen() const { return _isOpen; }
+
+	inline uint64_t getWrittenCount() const { return _writtenCount; }
+	inline uint64_t getDroppedCount() const { return _droppedCount; }
+	inline uint64_t getBytesWritten() const { return _bytesWritten; }
+
+	/// Tell how many frames are waiting for the disk
+	size_t getQueueSize();
+
+	/// The last I/O error, empty if none
+	std::string getError();
+
+private:
+	/// A block-aligned memory area holding a frame record
+	struct Buffer {
+		uint8_t * data = nullptr;
+		size_t capacity = 0;
+		size_t size = 0;
+
+		~Buffer();
+
+		/// Grows the buffer if needed. Content is lost.
+		void reserve(size_t size);
+	};
+
+	size_t _queueCapacity;
+
+	std::deque<std::unique_ptr<Buffer>> _queue;
+	std::vector<std::unique_ptr<Buffer>> _freeBuffers;
+	size_t _buffersCount = 0;
+
+	std::mutex _queueMutex;
+	std::condition_variable _queueCondition;
+
+	std::thread _writerThread;
+	bool _stopping = true;  // Until opened
+	std::atomic<bool> _isOpen = {false};
+
+	// Writer thread
+	std::vector<RawVideoFile::IndexEntry> _index;
+	uint64_t _writeOffset = 0;
+	bool _failed = false;
+
+	std::atomic<uint64_t> _writtenCount = {0};
+	std::atomic<uint64_t> _droppedCount = {0};
+	std::atomic<uint64_t> _bytesWritten = {0};
+
+	std::string _error;
+	std::mutex _errorMutex;
+
+#ifdef _WIN32
+	void * _file = nullptr;
+#else
+	int _file = -1;
+#endif
+
+	void writerLoop();
+
+	/// Writes the index and the final file header
+	void finalize();
+
+	/// Writes a block-aligned area at the given offset
+	/// @returns False on error, after recording it
+	bool writeAt(uint64_t offset, const uint8_t * data, size_t size);
+
+	void setError(const std::string &error);
+};
+
+#endif /* raw_video_writer_hpp */
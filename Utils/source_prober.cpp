@@ -0,0 +1,239 @@
+//
+//  source_prober.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "source_prober.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+constexpr std::chrono::seconds SourceProber::refreshInterval;
+constexpr std::chrono::seconds SourceProber::probeTimeout;
+
+std::shared_ptr<SourceProber> SourceProber::acquire() {
+	static std::mutex proberMutex;
+	static std::weak_ptr<SourceProber> sharedProber;
+
+	std::unique_lock<std::mutex> lock(proberMutex);
+
+	std::shared_ptr<SourceProber> prober = sharedProber.lock();
+
+	if(!prober) {
+		prober = std::shared_ptr<SourceProber>(new SourceProber());
+		sharedProber = prober;
+	}
+
+	return prober;
+}
+
+SourceProber::SourceProber() {
+	_probeThread = std::thread(&SourceProber::probeLoop, this);
+}
+
+SourceProber::~SourceProber() {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_condition.notify_all();
+	_probeThread.join();
+}
+
+void SourceProber::request(const NDIlib_source_t * sources, uint32_t count) {
+	const clock::time_point now = clock::now();
+	bool hasQueued = false;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		for(uint32_t i = 0; i < count; ++i) {
+			Entry &entry = _entries[sources[i].p_ndi_name];
+			entry.requestTime = now;
+
+			if(sources[i].p_url_address != nullptr)
+				entry.address = sources[i].p_url_address;
+
+			const bool isOutdated = entry.probeTime == clock::time_point() || now - entry.probeTime > refreshInterval;
+
+			if(entry.queued || !isOutdated)
+				continue;
+
+			entry.queued = true;
+			_queue.push_back(sources[i].p_ndi_name);
+			hasQueued = true;
+		}
+
+		// Forget the sources nobody asked for in a while
+		for(auto it = _entries.begin(); it != _entries.end();) {
+			if(!it->second.queued && now - it->second.requestTime > refreshInterval * 2)
+				it = _entries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	if(hasQueued)
+		_condition.notify_one();
+}
+
+bool SourceProber::getFormat(const std::string &name, Format &format) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto it = _entries.find(name);
+
+	if(it == _entries.end() || !it->second.format.probed)
+		return false;
+
+	format = it->second.format;
+	return true;
+}
+
+std::string SourceProber::fourCCString(uint32_t fourCC) {
+	std::string characters;
+
+	for(int i = 0; i < 4; ++i) {
+		const char character = static_cast<char>((fourCC >> (i * 8)) & 0xFF);
+
+		if(character != '\0')
+			characters += character;
+	}
+
+	return characters;
+}
+
+const std::vector<std::string> &SourceProber::getDescriptionHeaders() {
+	static const std::vector<std::string> headers = {"Proxy Resolution", "FPS", "FourCC", "Channels", "Sample Rate"};
+	return headers;
+}
+
+std::vector<std::string> SourceProber::describe(const Format &format) {
+	std::vector<std::string> description(getDescriptionHeaders().size());
+
+	if(format.hasVideo) {
+		description[0] = std::to_string(format.width) + "x" + std::to_string(format.height) + (format.progressive ? "" : "i");
+
+		char frameRate[16];
+		snprintf(frameRate, sizeof(frameRate), "%.2f", format.frameRateD != 0 ? static_cast<double>(format.frameRateN) / format.frameRateD : 0.);
+		description[1] = frameRate;
+
+		description[2] = fourCCString(format.fourCC);
+	}
+
+	if(format.hasAudio) {
+		description[3] = std::to_string(format.channelsCount);
+		description[4] = std::to_string(format.sampleRate);
+	}
+
+	return description;
+}
+
+void SourceProber::probeLoop() {
+	while(true) {
+		std::string name;
+		std::string address;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [&] { return _stopping || !_queue.empty(); });
+
+			if(_stopping)
+				return;
+
+			name = _queue.front();
+			_queue.pop_front();
+
+			auto it = _entries.find(name);
+
+			if(it == _entries.end())
+				continue;
+
+			address = it->second.address;
+		}
+
+		const Format format = probe(name, address);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		auto it = _entries.find(name);
+
+		if(it == _entries.end())
+			continue;
+
+		// Keep the previous format if the source did not answer this time
+		if(format.probed || !it->second.format.probed)
+			it->second.format = format;
+
+		it->second.queued = false;
+		it->second.probeTime = clock::now();
+	}
+}
+
+SourceProber::Format SourceProber::probe(const std::string &name, const std::string &address) {
+	Format format;
+
+	NDIlib_source_t source;
+	source.p_ndi_name = name.c_str();
+	source.p_url_address = address.empty() ? nullptr : address.c_str();
+
+	// Only the proxy stream is asked for, so the sources do not send us
+	// their full frames. Its resolution is scaled down, the rest matches.
+	NDIlib_recv_create_v3_t receiverOptions;
+	receiverOptions.source_to_connect_to = source;
+	receiverOptions.color_format = NDIlib_recv_color_format_fastest;
+	receiverOptions.bandwidth = NDIlib_recv_bandwidth_lowest;
+	receiverOptions.allow_video_fields = true;
+	receiverOptions.p_ndi_recv_name = "TouchDesigner NDI Prober";
+
+	NDIlib_recv_instance_t receiver = NDIlib_recv_create_v3(&receiverOptions);
+
+	if(receiver == nullptr)
+		return format;
+
+	clock::time_point deadline = clock::now() + probeTimeout;
+
+	while(clock::now() < deadline && !(format.hasVideo && format.hasAudio)) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			if(_stopping)
+				break;
+		}
+
+		NDIlib_video_frame_v2_t videoFrame;
+		NDIlib_audio_frame_v2_t audioFrame;
+
+		switch(NDIlib_recv_capture_v2(receiver, format.hasVideo ? nullptr : &videoFrame, format.hasAudio ? nullptr : &audioFrame, nullptr, 100)) {
+			case NDIlib_frame_type_video:
+				format.hasVideo = true;
+				format.width = videoFrame.xres;
+				format.height = videoFrame.yres;
+				format.frameRateN = videoFrame.frame_rate_N;
+				format.frameRateD = videoFrame.frame_rate_D;
+				format.fourCC = static_cast<uint32_t>(videoFrame.FourCC);
+				format.progressive = videoFrame.frame_format_type == NDIlib_frame_format_type_progressive;
+				NDIlib_recv_free_video_v2(receiver, &videoFrame);
+
+				// Sources without audio, do not wait for it for long
+				deadline = std::min(deadline, clock::now() + std::chrono::seconds(1));
+				break;
+			case NDIlib_frame_type_audio:
+				format.hasAudio = true;
+				format.channelsCount = audioFrame.no_channels;
+				format.sampleRate = audioFrame.sample_rate;
+				NDIlib_recv_free_audio_v2(receiver, &audioFrame);
+				break;
+			default:
+				break;
+		}
+	}
+
+	NDIlib_recv_destroy(receiver);
+
+	format.probed = format.hasVideo || format.hasAudio;
+	return format;
+}
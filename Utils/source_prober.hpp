@@ -0,0 +1,115 @@
+//
+//  source_prober.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef source_prober_hpp
+#define source_prober_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Processing.NDI.Lib.h>
+
+/// Finds out the video and audio format of NDI sources in the background.
+/// Each requested source is connected to briefly, one at a time, until one
+/// video and one audio frame have been received. Only the low bandwidth
+/// proxy stream is requested, so the resolution found is the proxy's.
+/// Formats are cached and probed again from time to time. One prober is
+/// shared by all the operators of the process.
+class SourceProber
+{
+public:
+	struct Format {
+		/// False until the source has been probed
+		bool probed = false;
+
+		bool hasVideo = false;
+
+		/// Resolution of the proxy stream, smaller than the source's
+		int width = 0;
+		int height = 0;
+		int frameRateN = 0;
+		int frameRateD = 1;
+		uint32_t fourCC = 0;
+		bool progressive = true;
+
+		bool hasAudio = false;
+		int channelsCount = 0;
+		int sampleRate = 0;
+	};
+
+	~SourceProber();
+
+	SourceProber(const SourceProber &) = delete;
+	SourceProber &operator=(const SourceProber &) = delete;
+
+	/// Gives the process-wide prober. It lives as long as one of the
+	/// operators holds it, and must be released before NDI is destroyed.
+	static std::shared_ptr<SourceProber> acquire();
+
+	/// Queues the sources which format is unknown or outdated
+	void request(const NDIlib_source_t * sources, uint32_t count);
+
+	/// Gives the cached format of a source
+	/// @returns False if the source has not been probed yet
+	bool getFormat(const std::string &name, Format &format);
+
+	/// Formats a FourCC as its four characters
+	static std::string fourCCString(uint32_t fourCC);
+
+	/// Names of the columns given by describe()
+	static const std::vector<std::string> &getDescriptionHeaders();
+
+	/// Describes a format as its proxy resolution, frame rate, FourCC, channels
+	/// count and sample rate. Unknown values are left empty.
+	static std::vector<std::string> describe(const Format &format);
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string address;
+		Format format;
+
+		bool queued = false;
+		clock::time_point probeTime;
+		clock::time_point requestTime;
+	};
+
+	/// Probes are redone after this long
+	static constexpr std::chrono::seconds refreshInterval = std::chrono::seconds(60);
+
+	/// Longest connection to a source
+	static constexpr std::chrono::seconds probeTimeout = std::chrono::seconds(3);
+
+	std::map<std::string, Entry> _entries;
+	std::deque<std::string> _queue;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stopping = false;
+
+	std::thread _probeThread;
+
+	SourceProber();
+
+	void probeLoop();
+
+	/// Connects to a source and waits for its first frames
+	/// @returns The format found, unprobed if the source did not answer
+	Format probe(const std::string &name, const std::string &address);
+};
+
+#endif /* source_prober_hpp */
@@ -0,0 +1,134 @@
+//
+//  sync_group.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "sync_group.hpp"
+#include "frame_queue.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+std::shared_ptr<SyncGroup> SyncGroup::join(const std::string &name) {
+	// Groups live as long as one of their members
+	static std::mutex groupsMutex;
+	static std::map<std::string, std::weak_ptr<SyncGroup>> groups;
+
+	std::unique_lock<std::mutex> lock(groupsMutex);
+
+	std::shared_ptr<SyncGroup> group = groups[name].lock();
+
+	if(!group) {
+		group = std::shared_ptr<SyncGroup>(new SyncGroup(name));
+		groups[name] = group;
+	}
+
+	return group;
+}
+
+SyncGroup::SyncGroup(const std::string &name):
+_name(name) {}
+
+void SyncGroup::addMember(FrameQueue * queue) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	if(std::find(_members.begin(), _members.end(), queue) == _members.end())
+		_members.push_back(queue);
+}
+
+void SyncGroup::removeMember(FrameQueue * queue) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_members.erase(std::remove(_members.begin(), _members.end(), queue), _members.end());
+}
+
+bool SyncGroup::resolve(int64_t cookFrame, bool timecode, int64_t tolerance, int64_t &key) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// Already decided by another member
+	if(cookFrame == _resolvedFrame) {
+		key = _releasedKey;
+		return _released;
+	}
+
+	_resolvedFrame = cookFrame;
+	_released = false;
+
+	if(_members.empty())
+		return false;
+
+	_keys.resize(_members.size());
+
+	for(size_t i = 0; i < _members.size(); ++i)
+		_members[i]->getKeys(_keys[i], timecode);
+
+	// How far apart the members are
+	int64_t newestMin = std::numeric_limits<int64_t>::max();
+	int64_t newestMax = std::numeric_limits<int64_t>::min();
+	bool everyMemberHasFrames = true;
+
+	for(const std::vector<int64_t> &keys: _keys) {
+		if(keys.empty()) {
+			everyMemberHasFrames = false;
+			continue;
+		}
+
+		newestMin = std::min(newestMin, keys.back());
+		newestMax = std::max(newestMax, keys.back());
+	}
+
+	if(newestMax >= newestMin) {
+		_stats.skew = newestMax - newestMin;
+		_stats.maxSkew = std::max(_stats.maxSkew, _stats.skew);
+		_stats.averageSkew += (static_cast<double>(_stats.skew) - _stats.averageSkew) * .05;
+	}
+
+	// The sources restarted, their keys went back in time
+	if(everyMemberHasFrames &&
+	   _releasedKey != std::numeric_limits<int64_t>::min() &&
+	   newestMax < _releasedKey - tolerance)
+		_releasedKey = std::numeric_limits<int64_t>::min();
+
+	// The newest key every member has, newer than the last one released
+	if(everyMemberHasFrames) {
+		const std::vector<int64_t> &candidates = _keys.front();
+
+		for(auto candidate = candidates.rbegin(); candidate != candidates.rend(); ++candidate) {
+			if(*candidate <= _releasedKey + tolerance)
+				break;
+
+			bool matched = true;
+
+			for(size_t i = 1; i < _keys.size() && matched; ++i) {
+				matched = std::any_of(_keys[i].begin(), _keys[i].end(), [&](int64_t memberKey) {
+					return std::abs(memberKey - *candidate) <= tolerance;
+				});
+			}
+
+			if(matched) {
+				_released = true;
+				_releasedKey = *candidate;
+				break;
+			}
+		}
+	}
+
+	if(_released)
+		++_stats.releasedFrames;
+	else
+		++_stats.stalledCooks;
+
+	key = _releasedKey;
+	return _released;
+}
+
+SyncGroup::Stats SyncGroup::getStats() {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	Stats stats = _stats;
+	stats.membersCount = _members.size();
+	return stats;
+}
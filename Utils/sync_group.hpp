@@ -0,0 +1,85 @@
+//
+//  sync_group.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef sync_group_hpp
+#define sync_group_hpp
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class FrameQueue;
+
+/// Coordinates receivers showing parts of the same picture. Frames are held
+/// in the members queues until every member has one with a matching
+/// timestamp or timecode, then all members show it on the same cook.
+class SyncGroup
+{
+public:
+	struct Stats {
+		size_t membersCount = 0;
+
+		// Cooks where frames were released, or held because a member had no
+		// matching frame yet
+		uint64_t releasedFrames = 0;
+		uint64_t stalledCooks = 0;
+
+		// Spread between the newest frames of the members, in 100 ns units
+		int64_t skew = 0;
+		int64_t maxSkew = 0;
+		double averageSkew = 0;
+	};
+
+	/// Gives the group with the given name, creating it if no receiver is
+	/// using it yet
+	static std::shared_ptr<SyncGroup> join(const std::string &name);
+
+	/// Registers the queue of a receiver
+	void addMember(FrameQueue * queue);
+
+	/// Unregisters the queue of a receiver
+	void removeMember(FrameQueue * queue);
+
+	/// Decides which frame the members show on the given cook. The first
+	/// member cooking in a TouchDesigner frame resolves it with its
+	/// settings, the others get the same answer.
+	/// @param cookFrame The absolute frame of the cook
+	/// @param timecode Match frames on their timecodes instead of timestamps
+	/// @param tolerance Largest difference between matching keys, in 100 ns units
+	/// @param key Set to the timestamp or timecode to show
+	/// @returns True if every member has a frame to show
+	bool resolve(int64_t cookFrame, bool timecode, int64_t tolerance, int64_t &key);
+
+	Stats getStats();
+
+	inline const std::string &getName() const { return _name; }
+
+private:
+	explicit SyncGroup(const std::string &name);
+
+	std::string _name;
+
+	std::vector<FrameQueue *> _members;
+
+	// Resolution of the current cook frame
+	int64_t _resolvedFrame = std::numeric_limits<int64_t>::min();
+	bool _released = false;
+	int64_t _releasedKey = std::numeric_limits<int64_t>::min();
+
+	// Keys of the queued frames of each member
+	std::vector<std::vector<int64_t>> _keys;
+
+	Stats _stats;
+
+	std::mutex _mutex;
+};
+
+#endif /* sync_group_hpp */
@@ -0,0 +1,147 @@
+//
+//  video_analyzer.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "video_analyzer.hpp"
+#include "hash_mix.hpp"
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include <immintrin.h>
+
+using HashMix::mixBits;
+using HashMix::mixBlock;
+
+void VideoAnalyzer::analyze(const uint8_t * data, int stride,
+							int width, int height,
+							const Settings &settings,
+							WorkerPool * pool) {
+	std::array<uint32_t, 256> histogram = {};
+	uint64_t hash = 0;
+	std::mutex resultMutex;
+
+	// Rows hashes are summed, so ranges can be merged in any order
+	const auto task = [&](int rowBegin, int rowEnd) {
+		std::array<uint32_t, 256> rangeHistogram = {};
+		const uint64_t rangeHash = analyzeRows(data, stride, width, rowBegin, rowEnd, rangeHistogram);
+
+		std::unique_lock<std::mutex> lock(resultMutex);
+
+		for(size_t i = 0; i < histogram.size(); ++i)
+			histogram[i] += rangeHistogram[i];
+
+		hash += rangeHash;
+	};
+
+	if(pool != nullptr)
+		pool->parallelFor(height, task, 64);
+	else
+		task(0, height);
+
+	_result.histogram = histogram;
+	_result.pixelsCount = static_cast<uint64_t>(width) * height;
+
+	uint64_t lumaSum = 0;
+	uint64_t blackPixels = 0;
+
+	for(size_t i = 0; i < histogram.size(); ++i) {
+		lumaSum += histogram[i] * i;
+
+		if(i <= settings.blackLevel)
+			blackPixels += histogram[i];
+	}
+
+	const double pixelsCount = static_cast<double>(std::max<uint64_t>(_result.pixelsCount, 1));
+
+	_result.averageLuma = lumaSum / pixelsCount;
+	_result.blackRatio = blackPixels / pixelsCount;
+	_result.isBlack = _result.blackRatio >= settings.blackRatio;
+
+	// Frozen pictures repeat the exact same pixels
+	if(_result.framesCount > 0 && hash == _result.hash)
+		++_result.identicalFrames;
+	else
+		_result.identicalFrames = 0;
+
+	_result.isFrozen = _result.identicalFrames >= static_cast<uint64_t>(std::max(settings.freezeFrames, 1));
+	_result.hash = hash;
+
+	++_result.framesCount;
+
+	if(_result.isBlack)
+		++_result.blackFrames;
+
+	if(_result.isFrozen)
+		++_result.frozenFrames;
+}
+
+void VideoAnalyzer::reset() {
+	_result = Result();
+}
+
+uint64_t VideoAnalyzer::analyzeRows(const uint8_t * data, int stride, int width,
+									int rowBegin, int rowEnd,
+									std::array<uint32_t, 256> &histogram) {
+	// BT.709 luma weights on 8 bits, for B, G, R and A
+	const __m128i weights = _mm_set_epi16(0, 54, 183, 19, 0, 54, 183, 19);
+	const __m128i zero = _mm_setzero_si128();
+
+	alignas(16) uint32_t luma[4];
+	alignas(16) uint64_t lanes[2];
+
+	uint64_t hash = 0;
+
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * row = data + y * stride;
+		__m128i rowHash = _mm_set1_epi32(y + 1);
+
+		int x = 0;
+
+		// Four pixels at a time
+		for(; x + 4 <= width; x += 4) {
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x * 4));
+
+			rowHash = mixBlock(rowHash, pixels);
+
+			// Weighted sums of the (B, G) and (R, A) pairs of each pixel
+			const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+			const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+
+			// Gather the pairs and add them
+			const __m128i loPairs = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+			const __m128i hiPairs = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+			const __m128i sums = _mm_add_epi32(_mm_unpacklo_epi64(loPairs, hiPairs),
+											   _mm_unpackhi_epi64(loPairs, hiPairs));
+
+			_mm_store_si128(reinterpret_cast<__m128i *>(luma), _mm_srli_epi32(sums, 8));
+
+			++histogram[luma[0]];
+			++histogram[luma[1]];
+			++histogram[luma[2]];
+			++histogram[luma[3]];
+		}
+
+		uint64_t tailHash = 0;
+
+		for(; x < width; ++x) {
+			const uint8_t * pixel = row + x * 4;
+			++histogram[(pixel[0] * 19 + pixel[1] * 183 + pixel[2] * 54) >> 8];
+
+			uint32_t value;
+			memcpy(&value, pixel, 4);
+			tailHash = tailHash * 31 + value;
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes), rowHash);
+		hash += mixBits(lanes[0] ^ mixBits(lanes[1] ^ tailHash ^ static_cast<uint64_t>(y)));
+	}
+
+	return hash;
+}
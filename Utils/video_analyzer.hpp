@@ -0,0 +1,81 @@
+//
+//  video_analyzer.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef video_analyzer_hpp
+#define video_analyzer_hpp
+
+#include <array>
+#include <cstdint>
+
+class WorkerPool;
+
+/// Measures the luma of 8 bits BGRA frames and detects black and frozen
+/// pictures. Frames are read once, computing the histogram and a hash of
+/// each row in the same pass.
+class VideoAnalyzer
+{
+public:
+	struct Settings {
+		/// Pixels at or below this luma are considered black
+		uint8_t blackLevel = 16;
+
+		/// Part of the pixels that must be black for the frame to be black
+		double blackRatio = .98;
+
+		/// Identical frames in a row before the picture is considered frozen
+		int freezeFrames = 30;
+	};
+
+	struct Result {
+		std::array<uint32_t, 256> histogram = {};
+		uint64_t pixelsCount = 0;
+
+		/// Average luma, from 0 to 255
+		double averageLuma = 0;
+
+		/// Part of the pixels at or below the black level
+		double blackRatio = 0;
+		bool isBlack = false;
+
+		/// Frames identical to the previous one, in a row
+		uint64_t identicalFrames = 0;
+		bool isFrozen = false;
+
+		// Frames analyzed, and how many were black or frozen
+		uint64_t framesCount = 0;
+		uint64_t blackFrames = 0;
+		uint64_t frozenFrames = 0;
+
+		uint64_t hash = 0;
+	};
+
+	/// Analyzes a frame, splitting rows over the given pool.
+	/// @param data The frame pixels
+	/// @param stride Size in bytes of a row
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	void analyze(const uint8_t * data, int stride,
+				 int width, int height,
+				 const Settings &settings,
+				 WorkerPool * pool);
+
+	/// Forgets the previous frames, when the source changes
+	void reset();
+
+	inline const Result &getResult() const { return _result; }
+
+private:
+	Result _result;
+
+	/// Adds the luma of the given rows to the histogram, and returns the
+	/// combined hash of the rows
+	static uint64_t analyzeRows(const uint8_t * data, int stride, int width,
+								int rowBegin, int rowEnd,
+								std::array<uint32_t, 256> &histogram);
+};
+
+#endif /* video_analyzer_hpp */
@@ -0,0 +1,328 @@
+//
+//  video_scaler.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "video_scaler.hpp"
+#include "worker_pool.hpp"
+#include "cpu_features.hpp"
+#include "fast_memcpy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+void VideoScaler::configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, Filter filter) {
+	if(srcWidth == _srcWidth && srcHeight == _srcHeight &&
+	   dstWidth == _dstWidth && dstHeight == _dstHeight &&
+	   filter == _filter)
+		return;
+
+	_srcWidth = srcWidth;
+	_srcHeight = srcHeight;
+	_dstWidth = dstWidth;
+	_dstHeight = dstHeight;
+	_filter = filter;
+
+	if(_filter == Filter::Box) {
+		// Each destination pixel covers at least one source pixel
+		auto buildBounds = [](int srcSize, int dstSize, std::vector<int> &bounds) {
+			bounds.resize(dstSize * 2);
+
+			for(int i = 0; i < dstSize; ++i) {
+				const int begin = static_cast<int>((static_cast<int64_t>(i) * srcSize) / dstSize);
+				const int end = static_cast<int>((static_cast<int64_t>(i + 1) * srcSize) / dstSize);
+
+				bounds[i * 2] = begin;
+				bounds[i * 2 + 1] = std::max(end, begin + 1);
+			}
+		};
+
+		buildBounds(_srcWidth, _dstWidth, _boxX);
+		buildBounds(_srcHeight, _dstHeight, _boxY);
+		return;
+	}
+
+	// Bilinear, sampling at pixel centers
+	auto buildWeights = [](int srcSize, int dstSize, std::vector<int> &indices, std::vector<int16_t> &weights) {
+		indices.resize(dstSize);
+		weights.resize(dstSize);
+
+		const double ratio = static_cast<double>(srcSize) / dstSize;
+
+		for(int i = 0; i < dstSize; ++i) {
+			double pos = (i + .5) * ratio - .5;
+			pos = std::max(0., std::min(pos, srcSize - 1.));
+
+			const int index = static_cast<int>(pos);
+			indices[i] = index;
+			weights[i] = static_cast<int16_t>(std::lround((pos - index) * 128.));
+		}
+	};
+
+	buildWeights(_srcWidth, _dstWidth, _bilinearX, _bilinearWX);
+	buildWeights(_srcHeight, _dstHeight, _bilinearY, _bilinearWY);
+}
+
+void VideoScaler::process(const uint8_t * src, int srcStride,
+						  uint8_t * dst, int dstStride,
+						  WorkerPool * pool) const {
+	if(pool == nullptr) {
+		processRows(src, srcStride, dst, dstStride, 0, _dstHeight);
+		return;
+	}
+
+	pool->parallelFor(_dstHeight, [&](int begin, int end) {
+		processRows(src, srcStride, dst, dstStride, begin, end);
+	});
+}
+
+void VideoScaler::processRows(const uint8_t * src, int srcStride,
+							  uint8_t * dst, int dstStride,
+							  int rowBegin, int rowEnd) const {
+	// Same size, plain copy
+	if(_srcWidth == _dstWidth && _srcHeight == _dstHeight) {
+		for(int y = rowBegin; y < rowEnd; ++y) {
+			memcpy_fast(dst + y * dstStride, src + y * srcStride, _dstWidth * 4);
+		}
+
+		return;
+	}
+
+	if(_filter == Filter::Box)
+		processBoxRows(src, srcStride, dst, dstStride, rowBegin, rowEnd);
+	else
+		processBilinearRows(src, srcStride, dst, dstStride, rowBegin, rowEnd);
+}
+
+void VideoScaler::halve(const uint8_t * src, int srcStride,
+						int srcWidth, int srcHeight,
+						uint8_t * dst, int dstStride,
+						WorkerPool * pool) {
+	const int dstWidth = srcWidth / 2;
+	const int dstHeight = srcHeight / 2;
+
+	if(pool == nullptr) {
+		halveRows(src, srcStride, dst, dstStride, dstWidth, 0, dstHeight);
+		return;
+	}
+
+	pool->parallelFor(dstHeight, [&](int begin, int end) {
+		halveRows(src, srcStride, dst, dstStride, dstWidth, begin, end);
+	});
+}
+
+void VideoScaler::halveRows(const uint8_t * src, int srcStride,
+							uint8_t * dst, int dstStride,
+							int dstWidth, int rowBegin, int rowEnd) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * top = src + 2 * y * srcStride;
+		const uint8_t * bottom = top + srcStride;
+		uint8_t * row = dst + y * dstStride;
+
+		int x = 0;
+
+		// 4 destination pixels from 8 pixels on each source row
+		for(; x + 4 <= dstWidth; x += 4) {
+			const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x * 8));
+			const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x * 8 + 16));
+			const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x * 8));
+			const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x * 8 + 16));
+
+			// Vertical sums on 16 bits, two pixels per register
+			const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+			const __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+			const __m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+			const __m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+			// Horizontal sums of neighbour pixels
+			__m128i pixels01 = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+			__m128i pixels23 = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67), _mm_unpackhi_epi64(sum45, sum67));
+
+			pixels01 = _mm_srli_epi16(_mm_add_epi16(pixels01, rounding), 2);
+			pixels23 = _mm_srli_epi16(_mm_add_epi16(pixels23, rounding), 2);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(row + x * 4), _mm_packus_epi16(pixels01, pixels23));
+		}
+
+		for(; x < dstWidth; ++x) {
+			for(int c = 0; c < 4; ++c) {
+				row[x * 4 + c] = static_cast<uint8_t>((top[x * 8 + c] + top[x * 8 + 4 + c] +
+													   bottom[x * 8 + c] + bottom[x * 8 + 4 + c] + 2) >> 2);
+			}
+		}
+	}
+}
+
+void VideoScaler::fitInside(int srcWidth, int srcHeight,
+							int maxWidth, int maxHeight,
+							int &width, int &height) {
+	width = srcWidth;
+	height = srcHeight;
+
+	if(width <= maxWidth && height <= maxHeight)
+		return;
+
+	const double scale = std::min(static_cast<double>(maxWidth) / srcWidth,
+								  static_cast<double>(maxHeight) / srcHeight);
+
+	width = std::max(1, std::min(maxWidth, static_cast<int>(srcWidth * scale)));
+	height = std::max(1, std::min(maxHeight, static_cast<int>(srcHeight * scale)));
+}
+
+// MARK: - Kernels
+
+/// Packs the four 32 bits lanes of a pixel back to 8 bits BGRA
+static inline void storePixel(uint8_t * dst, __m128i pixel) {
+	pixel = _mm_packs_epi32(pixel, pixel);
+	pixel = _mm_packus_epi16(pixel, pixel);
+	*reinterpret_cast<int32_t *>(dst) = _mm_cvtsi128_si32(pixel);
+}
+
+/// AVX2 version of accumulateRow(), for whole blocks of 16 values
+/// @returns The number of values accumulated
+AVX2_TARGET static int accumulateRowAVX2(const uint8_t * row, uint32_t * acc, int count) {
+	int i = 0;
+
+	for(; i + 16 <= count; i += 16) {
+		const __m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + i)));
+		const __m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + i + 8)));
+
+		__m256i * accPtr = reinterpret_cast<__m256i *>(acc + i);
+		_mm256_storeu_si256(accPtr, _mm256_add_epi32(_mm256_loadu_si256(accPtr), lo));
+		_mm256_storeu_si256(accPtr + 1, _mm256_add_epi32(_mm256_loadu_si256(accPtr + 1), hi));
+	}
+
+	return i;
+}
+
+/// Adds a row of 8 bits values to a row of 32 bits accumulators
+static inline void accumulateRow(const uint8_t * row, uint32_t * acc, int count, bool useAVX2) {
+	int i = useAVX2 ? accumulateRowAVX2(row, acc, count) : 0;
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for(; i + 16 <= count; i += 16) {
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+		const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+		__m128i * accPtr = reinterpret_cast<__m128i *>(acc + i);
+		_mm_storeu_si128(accPtr + 0, _mm_add_epi32(_mm_loadu_si128(accPtr + 0), _mm_unpacklo_epi16(lo, zero)));
+		_mm_storeu_si128(accPtr + 1, _mm_add_epi32(_mm_loadu_si128(accPtr + 1), _mm_unpackhi_epi16(lo, zero)));
+		_mm_storeu_si128(accPtr + 2, _mm_add_epi32(_mm_loadu_si128(accPtr + 2), _mm_unpacklo_epi16(hi, zero)));
+		_mm_storeu_si128(accPtr + 3, _mm_add_epi32(_mm_loadu_si128(accPtr + 3), _mm_unpackhi_epi16(hi, zero)));
+	}
+
+	for(; i < count; ++i) {
+		acc[i] += row[i];
+	}
+}
+
+void VideoScaler::processBoxRows(const uint8_t * src, int srcStride,
+								 uint8_t * dst, int dstStride,
+								 int rowBegin, int rowEnd) const {
+	// One accumulator per source channel, reused across calls on this thread
+	thread_local std::vector<uint32_t> acc;
+	acc.resize(_srcWidth * 4);
+
+	const bool useAVX2 = CPUFeatures::hasAVX2();
+
+	for(int dy = rowBegin; dy < rowEnd; ++dy) {
+		const int y0 = _boxY[dy * 2];
+		const int y1 = _boxY[dy * 2 + 1];
+
+		std::fill(acc.begin(), acc.end(), 0);
+
+		for(int y = y0; y < y1; ++y) {
+			accumulateRow(src + y * srcStride, acc.data(), _srcWidth * 4, useAVX2);
+		}
+
+		uint8_t * dstRow = dst + dy * dstStride;
+
+		for(int dx = 0; dx < _dstWidth; ++dx) {
+			const int x0 = _boxX[dx * 2];
+			const int x1 = _boxX[dx * 2 + 1];
+
+			// A BGRA pixel fits in a single register as four 32 bits sums
+			__m128i sum = _mm_setzero_si128();
+
+			for(int x = x0; x < x1; ++x) {
+				sum = _mm_add_epi32(sum, _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc.data() + x * 4)));
+			}
+
+			const __m128 scale = _mm_set1_ps(1.f / static_cast<float>((x1 - x0) * (y1 - y0)));
+			storePixel(dstRow + dx * 4, _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale)));
+		}
+	}
+}
+
+void VideoScaler::processBilinearRows(const uint8_t * src, int srcStride,
+									  uint8_t * dst, int dstStride,
+									  int rowBegin, int rowEnd) const {
+	// Vertically blended row, with 7 bits of extra precision
+	thread_local std::vector<int16_t> blended;
+	blended.resize(_srcWidth * 4);
+
+	const int rowBytes = _srcWidth * 4;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi32(1 << 13);
+
+	for(int dy = rowBegin; dy < rowEnd; ++dy) {
+		const int y0 = _bilinearY[dy];
+		const int y1 = std::min(y0 + 1, _srcHeight - 1);
+
+		const uint8_t * rowA = src + y0 * srcStride;
+		const uint8_t * rowB = src + y1 * srcStride;
+		const int16_t wy = _bilinearWY[dy];
+
+		// a * 128 + (b - a) * wy, stays in [0, 32640]
+		const __m128i weight = _mm_set1_epi16(wy);
+		int i = 0;
+
+		for(; i + 16 <= rowBytes; i += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rowA + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rowB + i));
+
+			const __m128i aLo = _mm_unpacklo_epi8(a, zero);
+			const __m128i aHi = _mm_unpackhi_epi8(a, zero);
+			const __m128i bLo = _mm_unpacklo_epi8(b, zero);
+			const __m128i bHi = _mm_unpackhi_epi8(b, zero);
+
+			const __m128i lo = _mm_add_epi16(_mm_slli_epi16(aLo, 7), _mm_mullo_epi16(_mm_sub_epi16(bLo, aLo), weight));
+			const __m128i hi = _mm_add_epi16(_mm_slli_epi16(aHi, 7), _mm_mullo_epi16(_mm_sub_epi16(bHi, aHi), weight));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(blended.data() + i), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(blended.data() + i + 8), hi);
+		}
+
+		for(; i < rowBytes; ++i) {
+			blended[i] = static_cast<int16_t>(rowA[i] * 128 + (rowB[i] - rowA[i]) * wy);
+		}
+
+		uint8_t * dstRow = dst + dy * dstStride;
+
+		for(int dx = 0; dx < _dstWidth; ++dx) {
+			const int x0 = _bilinearX[dx];
+			const int x1 = std::min(x0 + 1, _srcWidth - 1);
+			const int16_t wx = _bilinearWX[dx];
+
+			const __m128i left = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(blended.data() + x0 * 4));
+			const __m128i right = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(blended.data() + x1 * 4));
+
+			// left * (128 - wx) + right * wx for each channel in one madd
+			const __m128i pairs = _mm_unpacklo_epi16(left, right);
+			const __m128i weights = _mm_set1_epi32((static_cast<int32_t>(wx) << 16) | (128 - wx));
+			const __m128i sum = _mm_add_epi32(_mm_madd_epi16(pairs, weights), rounding);
+
+			storePixel(dstRow + dx * 4, _mm_srai_epi32(sum, 14));
+		}
+	}
+}
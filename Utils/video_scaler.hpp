@@ -0,0 +1,96 @@
+//
+//  video_scaler.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef video_scaler_hpp
+#define video_scaler_hpp
+
+#include <cstdint>
+#include <vector>
+
+class WorkerPool;
+
+/// Resizes 8 bits BGRA frames. Coefficients are computed once per
+/// source/destination sizes pair and kept until the sizes change.
+class VideoScaler
+{
+public:
+	enum class Filter {
+		/// Averages every source pixel covered by a destination pixel. Best
+		/// suited for downscaling.
+		Box,
+
+		/// Interpolates between the four nearest source pixels.
+		Bilinear
+	};
+
+	/// Prepares the scaler for the given sizes and filter. Does nothing if
+	/// they did not change since the last call.
+	void configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, Filter filter);
+
+	/// Scales the source frame into the destination frame, splitting rows
+	/// over the given pool.
+	/// @param src The source pixels, using the configured source size
+	/// @param srcStride Size in bytes of a source row
+	/// @param dst The destination pixels, using the configured destination size
+	/// @param dstStride Size in bytes of a destination row
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	void process(const uint8_t * src, int srcStride,
+				 uint8_t * dst, int dstStride,
+				 WorkerPool * pool) const;
+
+	/// Scales a range of destination rows. Safe to call concurrently on
+	/// different ranges.
+	void processRows(const uint8_t * src, int srcStride,
+					 uint8_t * dst, int dstStride,
+					 int rowBegin, int rowEnd) const;
+
+	inline int getDstWidth() const { return _dstWidth; }
+	inline int getDstHeight() const { return _dstHeight; }
+
+	/// Halves a frame on both axes by averaging each 2x2 block of pixels.
+	/// Much faster than a configured box scale, chain it to build a pyramid.
+	/// Odd last column and row are left out.
+	/// @param dst The destination pixels, of srcWidth / 2 by srcHeight / 2
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	static void halve(const uint8_t * src, int srcStride,
+					  int srcWidth, int srcHeight,
+					  uint8_t * dst, int dstStride,
+					  WorkerPool * pool);
+
+	/// Computes the largest size with the same aspect ratio as the source
+	/// that fits in the given bounds. Sizes are never increased.
+	static void fitInside(int srcWidth, int srcHeight,
+						  int maxWidth, int maxHeight,
+						  int &width, int &height);
+
+private:
+	int _srcWidth = 0;
+	int _srcHeight = 0;
+	int _dstWidth = 0;
+	int _dstHeight = 0;
+	Filter _filter = Filter::Box;
+
+	// Box: [begin, end) source columns/rows covered by each destination
+	// column/row, stored as pairs
+	std::vector<int> _boxX;
+	std::vector<int> _boxY;
+
+	// Bilinear: left/top source index and weight of the right/bottom
+	// neighbour, on 7 bits
+	std::vector<int> _bilinearX;
+	std::vector<int16_t> _bilinearWX;
+	std::vector<int> _bilinearY;
+	std::vector<int16_t> _bilinearWY;
+
+	void processBoxRows(const uint8_t * src, int srcStride, uint8_t * dst, int dstStride, int rowBegin, int rowEnd) const;
+	void processBilinearRows(const uint8_t * src, int srcStride, uint8_t * dst, int dstStride, int rowBegin, int rowEnd) const;
+
+	static void halveRows(const uint8_t * src, int srcStride, uint8_t * dst, int dstStride, int dstWidth, int rowBegin, int rowEnd);
+};
+
+#endif /* video_scaler_hpp */
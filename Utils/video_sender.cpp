@@ -0,0 +1,280 @@
+//
+//  video_sender.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "video_sender.hpp"
+
+#include <chrono>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+/// Buffers start on a page and are sized in whole pages
+static const size_t pageSize = 4096;
+
+// MARK: - Buffer
+
+VideoSender::Buffer::~Buffer() {
+#ifdef _WIN32
+	_aligned_free(data);
+#else
+	free(data);
+#endif
+}
+
+void VideoSender::Buffer::reserve(size_t requestedSize) {
+	if(requestedSize <= capacity)
+		return;
+
+	requestedSize = (requestedSize + pageSize - 1) / pageSize * pageSize;
+
+#ifdef _WIN32
+	_aligned_free(data);
+	data = static_cast<uint8_t *>(_aligned_malloc(requestedSize, pageSize));
+#else
+	free(data);
+
+	void * memory = nullptr;
+	data = posix_memalign(&memory, pageSize, requestedSize) == 0 ? static_cast<uint8_t *>(memory) : nullptr;
+#endif
+
+	if(data == nullptr) {
+		capacity = 0;
+		throw std::bad_alloc();
+	}
+
+	capacity = requestedSize;
+}
+
+// MARK: - Sender
+
+VideoSender::~VideoSender() {
+	stop();
+}
+
+void VideoSender::start(NDIlib_send_instance_t feed) {
+	if(_thread.joinable())
+		return;
+
+	_feed = feed;
+	_stopping = false;
+	_thread = std::thread(&VideoSender::sendLoop, this);
+}
+
+void VideoSender::stop() {
+	if(!_thread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_condition.notify_all();
+	_thread.join();
+
+	_feed = nullptr;
+	_connectionsCount = 0;
+	_onProgram = false;
+	_onPreview = false;
+}
+
+std::unique_ptr<VideoSender::Buffer> VideoSender::acquire(size_t size) {
+	std::unique_ptr<Buffer> buffer;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if(!_freeBuffers.empty()) {
+			buffer = std::move(_freeBuffers.back());
+			_freeBuffers.pop_back();
+		} else if(_allocatedCount < buffersCount) {
+			buffer.reset(new Buffer());
+			++_allocatedCount;
+		} else {
+			return nullptr;
+		}
+	}
+
+	buffer->reserve(size);
+	return buffer;
+}
+
+void VideoSender::send(std::unique_ptr<Buffer> buffer, const NDIlib_video_frame_v2_t &frame) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		// Not sent in time, replaced by the newer one
+		if(_queuedBuffer) {
+			_freeBuffers.push_back(std::move(_queuedBuffer));
+			++_droppedCount;
+		}
+
+		_queuedBuffer = std::move(buffer);
+		_queuedFrame = frame;
+		_queuedFrame.p_data = _queuedBuffer->data;
+		_queuedFrame.p_metadata = _queuedBuffer->metadata.empty() ? nullptr : _queuedBuffer->metadata.c_str();
+	}
+
+	_condition.notify_one();
+}
+
+void VideoSender::repeat() {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_repeatQueued = true;
+	}
+
+	_condition.notify_one();
+}
+
+void VideoSender::setPacing(int frameRateN, int frameRateD) {
+	if(frameRateN <= 0 || frameRateD <= 0) {
+		frameRateN = 0;
+		frameRateD = 1;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if(frameRateN == _pacingN && frameRateD == _pacingD)
+			return;
+
+		_pacingN = frameRateN;
+		_pacingD = frameRateD;
+		_pacingChanged = true;
+	}
+
+	_condition.notify_one();
+}
+
+void VideoSender::recycle(std::unique_ptr<Buffer> buffer) {
+	if(!buffer)
+		return;
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_freeBuffers.push_back(std::move(buffer));
+}
+
+void VideoSender::sendLoop() {
+	using clock = std::chrono::steady_clock;
+
+	// Held by the SDK until the next send
+	std::unique_ptr<Buffer> sentBuffer;
+	NDIlib_video_frame_v2_t sentFrame;
+
+	// Paced clock. Ticks are computed from the start so rounding errors do
+	// not add up.
+	clock::time_point pacingStart = clock::now();
+	int64_t tick = 0;
+
+	while(true) {
+		std::unique_ptr<Buffer> buffer;
+		NDIlib_video_frame_v2_t frame;
+		bool isRepeat = false;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			if(_pacingChanged) {
+				_pacingChanged = false;
+				pacingStart = clock::now();
+				tick = 0;
+			}
+
+			if(_pacingN > 0) {
+				const auto tickTime = [&](int64_t index) {
+					return pacingStart + std::chrono::nanoseconds(index * 1000000000LL * _pacingD / _pacingN);
+				};
+
+				_condition.wait_until(lock, tickTime(tick), [&] { return _stopping || _pacingChanged; });
+
+				if(_stopping)
+					break;
+
+				if(_pacingChanged)
+					continue;
+
+				++tick;
+
+				// N frames last exactly D seconds, move the start there to
+				// keep the numbers small
+				if(tick == _pacingN) {
+					pacingStart += std::chrono::seconds(_pacingD);
+					tick = 0;
+				}
+
+				// Woke up too late, restart the clock rather than bursting
+				// the missed frames
+				if(clock::now() >= tickTime(tick)) {
+					++_lateTicksCount;
+					pacingStart = clock::now();
+					tick = 0;
+				}
+
+				// Nothing new on this tick, keep the cadence with the last frame
+				buffer = std::move(_queuedBuffer);
+				frame = _queuedFrame;
+				isRepeat = !buffer && sentBuffer;
+				_repeatQueued = false;
+			} else {
+				// Poll the connections often while no one is connected, so new
+				// receivers are noticed within a frame
+				const std::chrono::milliseconds pollInterval(_connectionsCount > 0 ? 100 : 10);
+				_condition.wait_for(lock, pollInterval, [&] { return _stopping || _queuedBuffer || _repeatQueued || _pacingChanged; });
+
+				if(_stopping)
+					break;
+
+				buffer = std::move(_queuedBuffer);
+				frame = _queuedFrame;
+
+				// A new frame supersedes the repeat
+				isRepeat = _repeatQueued && !buffer && sentBuffer;
+				_repeatQueued = false;
+			}
+		}
+
+		if(buffer) {
+			NDIlib_send_send_video_async_v2(_feed, &frame);
+			++_sentCount;
+
+			// The SDK is done with the previous frame
+			recycle(std::move(sentBuffer));
+			sentBuffer = std::move(buffer);
+			sentFrame = frame;
+		} else if(isRepeat) {
+			// Same pages, still ours until the next send
+			NDIlib_send_send_video_async_v2(_feed, &sentFrame);
+			++_repeatedCount;
+		}
+
+		_connectionsCount = NDIlib_send_get_no_connections(_feed, 0);
+
+		NDIlib_tally_t tally;
+		NDIlib_send_get_tally(_feed, &tally, 0);
+		_onProgram = tally.on_program;
+		_onPreview = tally.on_preview;
+	}
+
+	// Wait for the SDK to release the last frame
+	NDIlib_send_send_video_async_v2(_feed, nullptr);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	if(sentBuffer)
+		_freeBuffers.push_back(std::move(sentBuffer));
+
+	if(_queuedBuffer)
+		_freeBuffers.push_back(std::move(_queuedBuffer));
+
+	_repeatQueued = false;
+}
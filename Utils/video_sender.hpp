@@ -0,0 +1,147 @@
+//
+//  video_sender.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef video_sender_hpp
+#define video_sender_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Processing.NDI.Lib.h>
+
+/// Sends video frames to a NDI feed from a dedicated thread. Frames are
+/// written by the caller into page-aligned buffers owned by the sender, then
+/// queued. The sender thread gives them to the asynchronous send and only
+/// recycles a buffer once the SDK released it, on the following send.
+///
+/// Only the latest queued frame is kept: if the sender thread falls behind,
+/// older frames are dropped instead of blocking the caller.
+///
+/// Frames can also be paced: the sender thread then sends at exact
+/// intervals, the latest queued frame on each tick or the last one again if
+/// none came in time, so receivers see a steady cadence whatever the caller
+/// pace.
+///
+/// The sender thread also keeps track of the receivers connected to the
+/// feed and of its tally, so callers can skip their work when nobody watches.
+class VideoSender
+{
+public:
+	/// A page-aligned memory area holding a frame
+	struct Buffer {
+		uint8_t * data = nullptr;
+		size_t capacity = 0;
+
+		/// XML attached to the frame, none if empty. Its storage is reused
+		/// along with the buffer.
+		std::string metadata;
+
+		~Buffer();
+
+		/// Grows the buffer if needed. Content is lost.
+		void reserve(size_t size);
+	};
+
+	VideoSender() = default;
+	~VideoSender();
+
+	VideoSender(const VideoSender &) = delete;
+	VideoSender &operator=(const VideoSender &) = delete;
+
+	/// Starts the sender thread on the given feed
+	/// Does nothing if the thread is already running
+	void start(NDIlib_send_instance_t feed);
+
+	/// Stops the sender thread once it released every buffer. Must be called
+	/// before destroying the feed.
+	void stop();
+
+	inline bool isRunning() const { return _thread.joinable(); }
+
+	/// Gives a buffer to write a frame into
+	/// @param size The number of bytes needed
+	/// @returns Nullptr if every buffer is in use
+	std::unique_ptr<Buffer> acquire(size_t size);
+
+	/// Queues a frame for sending
+	/// @param buffer A buffer given by acquire(), holding the frame
+	/// @param frame Description of the frame. Its data and metadata pointers
+	/// are set to the buffer by the sender.
+	void send(std::unique_ptr<Buffer> buffer, const NDIlib_video_frame_v2_t &frame);
+
+	/// Sends the last frame again, without copying it. Does nothing if a
+	/// new frame is already queued.
+	void repeat();
+
+	/// Sends on a steady clock from now on, or as frames are queued
+	/// Does nothing if the rate did not change
+	/// @param frameRateN Numerator of the frame rate. 0 disables pacing.
+	/// @param frameRateD Denominator of the frame rate
+	void setPacing(int frameRateN, int frameRateD);
+
+	/// Gives back an unused buffer
+	void recycle(std::unique_ptr<Buffer> buffer);
+
+	/// Tell how many receivers are connected, as last polled by the sender
+	/// thread. Without receivers, new connections are noticed within 10 ms.
+	inline int getConnectionsCount() const { return _connectionsCount; }
+
+	/// Tell if a receiver shows the feed on program or on preview, as last
+	/// polled by the sender thread
+	inline bool isOnProgram() const { return _onProgram; }
+	inline bool isOnPreview() const { return _onPreview; }
+
+	inline uint64_t getSentCount() const { return _sentCount; }
+	inline uint64_t getDroppedCount() const { return _droppedCount; }
+	inline uint64_t getRepeatedCount() const { return _repeatedCount; }
+
+	/// Ticks missed by the paced clock, when the thread woke up too late
+	inline uint64_t getLateTicksCount() const { return _lateTicksCount; }
+
+private:
+	/// Filled by the caller, queued, then held by the SDK
+	static const size_t buffersCount = 3;
+
+	NDIlib_send_instance_t _feed = nullptr;
+
+	std::thread _thread;
+	bool _stopping = false;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	std::vector<std::unique_ptr<Buffer>> _freeBuffers;
+	size_t _allocatedCount = 0;
+
+	std::unique_ptr<Buffer> _queuedBuffer;
+	NDIlib_video_frame_v2_t _queuedFrame;
+	bool _repeatQueued = false;
+
+	int _pacingN = 0;
+	int _pacingD = 1;
+	bool _pacingChanged = false;
+
+	std::atomic<int> _connectionsCount = {0};
+	std::atomic<bool> _onProgram = {false};
+	std::atomic<bool> _onPreview = {false};
+
+	std::atomic<uint64_t> _sentCount = {0};
+	std::atomic<uint64_t> _droppedCount = {0};
+	std::atomic<uint64_t> _repeatedCount = {0};
+	std::atomic<uint64_t> _lateTicksCount = {0};
+
+	void sendLoop();
+};
+
+#endif /* video_sender_hpp */
@@ -0,0 +1,161 @@
+//
+//  worker_pool.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int threadsCount) {
+	if(threadsCount == 0) {
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadsCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	_threads.reserve(threadsCount);
+
+	for(unsigned int i = 0; i < threadsCount; ++i) {
+		_threads.emplace_back(&WorkerPool::workerLoop, this);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::unique_lock<std::mutex> lock(_tasksMutex);
+		_stopping = true;
+	}
+
+	_tasksCondition.notify_all();
+
+	for(std::thread &thread: _threads) {
+		thread.join();
+	}
+}
+
+std::shared_ptr<WorkerPool> WorkerPool::acquire() {
+	static std::mutex poolMutex;
+	static std::weak_ptr<WorkerPool> sharedPool;
+
+	std::unique_lock<std::mutex> lock(poolMutex);
+
+	std::shared_ptr<WorkerPool> pool = sharedPool.lock();
+
+	if(!pool) {
+		pool = std::make_shared<WorkerPool>();
+		sharedPool = pool;
+	}
+
+	return pool;
+}
+
+void WorkerPool::parallelFor(int count,
+							 const std::function<void(int, int)> &task,
+							 int minItemsPerTask) {
+	if(count <= 0)
+		return;
+
+	// Two ranges per thread gives some room for load balancing
+	const int maxTasks = static_cast<int>(getConcurrency()) * 2;
+	const int tasksCount = std::max(1, std::min(maxTasks, count / std::max(1, minItemsPerTask)));
+
+	if(tasksCount == 1) {
+		task(0, count);
+		return;
+	}
+
+	// Shared with the queued tasks so it outlives this call until the last
+	// of them is done with it
+	struct Completion {
+		std::atomic<int> remaining;
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	std::shared_ptr<Completion> completion = std::make_shared<Completion>();
+	completion->remaining = tasksCount;
+
+	const int itemsPerTask = (count + tasksCount - 1) / tasksCount;
+
+	{
+		std::unique_lock<std::mutex> lock(_tasksMutex);
+
+		// The first range is kept for the calling thread
+		for(int i = 1; i < tasksCount; ++i) {
+			const int begin = i * itemsPerTask;
+			const int end = std::min(count, begin + itemsPerTask);
+
+			_tasks.emplace_back([&task, completion, begin, end] {
+				if(begin < end)
+					task(begin, end);
+
+				if(--completion->remaining == 0) {
+					std::unique_lock<std::mutex> doneLock(completion->mutex);
+					completion->condition.notify_all();
+				}
+			});
+		}
+	}
+
+	_tasksCondition.notify_all();
+
+	task(0, std::min(count, itemsPerTask));
+	--completion->remaining;
+
+	// Help with the queue instead of sleeping while our ranges are pending
+	while(completion->remaining.load() != 0) {
+		if(runPendingTask())
+			continue;
+
+		std::unique_lock<std::mutex> doneLock(completion->mutex);
+		completion->condition.wait(doneLock, [&] { return completion->remaining.load() == 0; });
+	}
+}
+
+void WorkerPool::enqueue(std::function<void()> task) {
+	{
+		std::unique_lock<std::mutex> lock(_tasksMutex);
+		_tasks.push_back(std::move(task));
+	}
+
+	_tasksCondition.notify_one();
+}
+
+bool WorkerPool::runPendingTask() {
+	std::function<void()> task;
+
+	{
+		std::unique_lock<std::mutex> lock(_tasksMutex);
+
+		if(_tasks.empty())
+			return false;
+
+		task = std::move(_tasks.front());
+		_tasks.pop_front();
+	}
+
+	task();
+	return true;
+}
+
+void WorkerPool::workerLoop() {
+	while(true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(_tasksMutex);
+			_tasksCondition.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+			if(_stopping && _tasks.empty())
+				return;
+
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,79 @@
+//
+//  worker_pool.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef worker_pool_hpp
+#define worker_pool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A small pool of threads used to split per-frame pixel work across cores.
+/// One pool is shared by all the operators of the process so that multiple
+/// nodes do not oversubscribe the CPU.
+///
+/// The operators own the shared pool: its threads are joined when the last
+/// of them is destroyed, never from a static destructor, which on Windows
+/// runs under the loader lock when the plugin is unloaded.
+class WorkerPool
+{
+public:
+	/// @param threadsCount Number of worker threads. 0 picks one less than
+	/// the number of hardware threads, as the calling thread helps too.
+	explicit WorkerPool(unsigned int threadsCount = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/// The process-wide pool. It lives as long as one of the operators holds
+	/// it, and is joined when the last one is destroyed rather than by a
+	/// static destructor. Holders declare it before any member whose threads
+	/// use it, so those are stopped before the pool is released.
+	static std::shared_ptr<WorkerPool> acquire();
+
+	/// Splits [0, count) in contiguous ranges and runs the task on each of
+	/// them in parallel. The calling thread takes part in the work and this
+	/// method only returns once every range has been processed.
+	/// @param count The number of items (usually rows) to process
+	/// @param task Called with the [begin, end) range of items to process
+	/// @param minItemsPerTask Ranges will never be smaller than this
+	void parallelFor(int count,
+					 const std::function<void(int begin, int end)> &task,
+					 int minItemsPerTask = 16);
+
+	/// Queues a task to be run on one of the worker threads, without waiting
+	/// for it.
+	void enqueue(std::function<void()> task);
+
+	/// Tell how many threads may run tasks, including the calling one
+	/// @returns The number of workers plus one
+	inline unsigned int getConcurrency() const { return static_cast<unsigned int>(_threads.size()) + 1; }
+
+private:
+	std::vector<std::thread> _threads;
+	std::deque<std::function<void()>> _tasks;
+
+	std::mutex _tasksMutex;
+	std::condition_variable _tasksCondition;
+
+	bool _stopping = false;
+
+	/// Pops and runs one queued task, if any.
+	/// @returns True if a task was run
+	bool runPendingTask();
+
+	void workerLoop();
+};
+
+#endif /* worker_pool_hpp */
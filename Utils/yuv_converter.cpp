@@ -0,0 +1,589 @@
+//
+//  yuv_converter.cpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#include "yuv_converter.hpp"
+#include "cpu_features.hpp"
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace {
+
+/// Weights of the B, G and R channels, on 15 bits, scaled to video range
+struct Coefficients {
+	int16_t yB, yG, yR;
+	int16_t uB, uG, uR;
+	int16_t vB, vG, vR;
+
+	explicit Coefficients(double kr, double kb) {
+		const double kg = 1. - kr - kb;
+		const double yScale = 219. / 255. * 32768.;
+		const double cScale = 224. / 255. * 32768.;
+
+		auto weight = [](double value) { return static_cast<int16_t>(std::lround(value)); };
+
+		yB = weight(kb * yScale);
+		yG = weight(kg * yScale);
+		yR = weight(kr * yScale);
+
+		// Cb = (B - Y) / (2 * (1 - kb)), Cr = (R - Y) / (2 * (1 - kr))
+		uB = weight(.5 * cScale);
+		uG = weight(-kg / (2. * (1. - kb)) * cScale);
+		uR = weight(-kr / (2. * (1. - kb)) * cScale);
+
+		vB = weight(-kb / (2. * (1. - kr)) * cScale);
+		vG = weight(-kg / (2. * (1. - kr)) * cScale);
+		vR = weight(.5 * cScale);
+	}
+};
+
+const Coefficients &getCoefficients(YUVConverter::Matrix matrix) {
+	static const Coefficients bt601(.299, .114);
+	static const Coefficients bt709(.2126, .0722);
+
+	return matrix == YUVConverter::Matrix::BT709 ? bt709 : bt601;
+}
+
+// Luma sums are on 15 bits, chroma sums of two pixels on 16 bits
+const int yOffset = (16 << 15) + (1 << 14);
+const int cOffset = (128 << 16) + (1 << 15);
+
+/// Converts two horizontal pixels to a UYVY macropixel
+inline void convertPair(const uint8_t * p0, const uint8_t * p1, uint8_t * out, const Coefficients &c) {
+	const int b = p0[0] + p1[0];
+	const int g = p0[1] + p1[1];
+	const int r = p0[2] + p1[2];
+
+	out[0] = static_cast<uint8_t>((c.uB * b + c.uG * g + c.uR * r + cOffset) >> 16);
+	out[1] = static_cast<uint8_t>((c.yB * p0[0] + c.yG * p0[1] + c.yR * p0[2] + yOffset) >> 15);
+	out[2] = static_cast<uint8_t>((c.vB * b + c.vG * g + c.vR * r + cOffset) >> 16);
+	out[3] = static_cast<uint8_t>((c.yB * p1[0] + c.yG * p1[1] + c.yR * p1[2] + yOffset) >> 15);
+}
+
+/// [a0 + a1, a2 + a3, b0 + b1, b2 + b3]
+inline __m128i addPairs(__m128i a, __m128i b) {
+	const __m128 fa = _mm_castsi128_ps(a);
+	const __m128 fb = _mm_castsi128_ps(b);
+	const __m128i even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+	const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm_add_epi32(even, odd);
+}
+
+struct Kernel {
+	__m128i y, u, v;
+	__m128i yOffset, cOffset;
+
+	explicit Kernel(const Coefficients &c):
+	y(_mm_setr_epi16(c.yB, c.yG, c.yR, 0, c.yB, c.yG, c.yR, 0)),
+	u(_mm_setr_epi16(c.uB, c.uG, c.uR, 0, c.uB, c.uG, c.uR, 0)),
+	v(_mm_setr_epi16(c.vB, c.vG, c.vR, 0, c.vB, c.vG, c.vR, 0)),
+	yOffset(_mm_set1_epi32(::yOffset)),
+	cOffset(_mm_set1_epi32(::cOffset)) {}
+};
+
+/// Converts 4 pixels to UYVY macropixels, one 16 bits component per
+/// 16 bits lane
+inline __m128i convert4(__m128i pixels, const Kernel &k) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_unpacklo_epi8(pixels, zero);  // p0 p1
+	const __m128i hi = _mm_unpackhi_epi8(pixels, zero);  // p2 p3
+
+	// Per pixel
+	const __m128i y = addPairs(_mm_madd_epi16(lo, k.y), _mm_madd_epi16(hi, k.y));
+	const __m128i u = addPairs(_mm_madd_epi16(lo, k.u), _mm_madd_epi16(hi, k.u));
+	const __m128i v = addPairs(_mm_madd_epi16(lo, k.v), _mm_madd_epi16(hi, k.v));
+
+	// Per pair of pixels, U01 U23 V01 V23, reordered to U01 V01 U23 V23
+	__m128i uv = _mm_srai_epi32(_mm_add_epi32(addPairs(u, v), k.cOffset), 16);
+	uv = _mm_shuffle_epi32(uv, _MM_SHUFFLE(3, 1, 2, 0));
+
+	const __m128i luma = _mm_srai_epi32(_mm_add_epi32(y, k.yOffset), 15);
+	return _mm_or_si128(uv, _mm_slli_epi32(luma, 16));
+}
+
+inline int convertRow(const uint8_t * src, uint8_t * dst, int width, const Kernel &k) {
+	int x = 0;
+
+	for(; x + 8 <= width; x += 8) {
+		const __m128i a = convert4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4)), k);
+		const __m128i b = convert4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4 + 16)), k);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 2), _mm_packus_epi16(a, b));
+	}
+
+	return x;
+}
+
+inline int extractAlpha(const uint8_t * src, uint8_t * alpha, int width) {
+	int x = 0;
+
+	for(; x + 16 <= width; x += 16) {
+		const __m128i * pixels = reinterpret_cast<const __m128i *>(src + x * 4);
+
+		const __m128i a01 = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(pixels + 0), 24),
+											_mm_srli_epi32(_mm_loadu_si128(pixels + 1), 24));
+		const __m128i a23 = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(pixels + 2), 24),
+											_mm_srli_epi32(_mm_loadu_si128(pixels + 3), 24));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(alpha + x), _mm_packus_epi16(a01, a23));
+	}
+
+	return x;
+}
+
+// MARK: - AVX2
+
+/// [a0 + a1, a2 + a3, b0 + b1, b2 + b3] on each lane
+AVX2_TARGET inline __m256i addPairsAVX2(__m256i a, __m256i b) {
+	const __m256 fa = _mm256_castsi256_ps(a);
+	const __m256 fb = _mm256_castsi256_ps(b);
+	const __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+	const __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm256_add_epi32(even, odd);
+}
+
+struct KernelAVX2 {
+	__m256i y, u, v;
+	__m256i yOffset, cOffset;
+
+	AVX2_TARGET explicit KernelAVX2(const Coefficients &c):
+	y(_mm256_setr_epi16(c.yB, c.yG, c.yR, 0, c.yB, c.yG, c.yR, 0, c.yB, c.yG, c.yR, 0, c.yB, c.yG, c.yR, 0)),
+	u(_mm256_setr_epi16(c.uB, c.uG, c.uR, 0, c.uB, c.uG, c.uR, 0, c.uB, c.uG, c.uR, 0, c.uB, c.uG, c.uR, 0)),
+	v(_mm256_setr_epi16(c.vB, c.vG, c.vR, 0, c.vB, c.vG, c.vR, 0, c.vB, c.vG, c.vR, 0, c.vB, c.vG, c.vR, 0)),
+	yOffset(_mm256_set1_epi32(::yOffset)),
+	cOffset(_mm256_set1_epi32(::cOffset)) {}
+};
+
+/// Converts 8 pixels to UYVY macropixels, one 16 bits component per
+/// 16 bits lane, pixels 0-3 on the low lane and 4-7 on the high one
+AVX2_TARGET inline __m256i convert8(__m256i pixels, const KernelAVX2 &k) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lo = _mm256_unpacklo_epi8(pixels, zero);  // p0 p1 | p4 p5
+	const __m256i hi = _mm256_unpackhi_epi8(pixels, zero);  // p2 p3 | p6 p7
+
+	// Per pixel
+	const __m256i y = addPairsAVX2(_mm256_madd_epi16(lo, k.y), _mm256_madd_epi16(hi, k.y));
+	const __m256i u = addPairsAVX2(_mm256_madd_epi16(lo, k.u), _mm256_madd_epi16(hi, k.u));
+	const __m256i v = addPairsAVX2(_mm256_madd_epi16(lo, k.v), _mm256_madd_epi16(hi, k.v));
+
+	// Per pair of pixels, U01 U23 V01 V23, reordered to U01 V01 U23 V23
+	__m256i uv = _mm256_srai_epi32(_mm256_add_epi32(addPairsAVX2(u, v), k.cOffset), 16);
+	uv = _mm256_shuffle_epi32(uv, _MM_SHUFFLE(3, 1, 2, 0));
+
+	const __m256i luma = _mm256_srai_epi32(_mm256_add_epi32(y, k.yOffset), 15);
+	return _mm256_or_si256(uv, _mm256_slli_epi32(luma, 16));
+}
+
+/// AVX2 version of convertRow(), for whole blocks of 16 pixels
+/// @returns The number of pixels converted
+AVX2_TARGET int convertRowAVX2(const uint8_t * src, uint8_t * dst, int width, const Coefficients &c) {
+	const KernelAVX2 k(c);
+	int x = 0;
+
+	for(; x + 16 <= width; x += 16) {
+		const __m256i a = convert8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 4)), k);
+		const __m256i b = convert8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 4 + 32)), k);
+
+		// a0-3 b0-3 | a4-7 b4-7, back in order
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 2), packed);
+	}
+
+	return x;
+}
+
+/// AVX2 version of extractAlpha(), for whole blocks of 32 pixels
+/// @returns The number of pixels extracted
+AVX2_TARGET int extractAlphaAVX2(const uint8_t * src, uint8_t * alpha, int width) {
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int x = 0;
+
+	for(; x + 32 <= width; x += 32) {
+		const __m256i * pixels = reinterpret_cast<const __m256i *>(src + x * 4);
+
+		const __m256i a01 = _mm256_packs_epi32(_mm256_srli_epi32(_mm256_loadu_si256(pixels + 0), 24),
+											   _mm256_srli_epi32(_mm256_loadu_si256(pixels + 1), 24));
+		const __m256i a23 = _mm256_packs_epi32(_mm256_srli_epi32(_mm256_loadu_si256(pixels + 2), 24),
+											   _mm256_srli_epi32(_mm256_loadu_si256(pixels + 3), 24));
+
+		// Groups of four pixels come out interleaved between the lanes
+		const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a01, a23), order);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(alpha + x), packed);
+	}
+
+	return x;
+}
+
+// MARK: - 16 bits
+
+/// Weights of the R, G and B channels for normalized values, and the scales
+/// of the 16 bits video range
+struct FloatCoefficients {
+	float yR, yG, yB;
+	float uR, uG, uB;
+	float vR, vG, vB;
+
+	explicit FloatCoefficients(double kr, double kb) {
+		const double kg = 1. - kr - kb;
+		const double yScale = 219. * 256.;
+		const double cScale = 224. * 256.;
+
+		yR = static_cast<float>(kr * yScale);
+		yG = static_cast<float>(kg * yScale);
+		yB = static_cast<float>(kb * yScale);
+
+		uR = static_cast<float>(-kr / (2. * (1. - kb)) * cScale);
+		uG = static_cast<float>(-kg / (2. * (1. - kb)) * cScale);
+		uB = static_cast<float>(.5 * cScale);
+
+		vR = static_cast<float>(.5 * cScale);
+		vG = static_cast<float>(-kg / (2. * (1. - kr)) * cScale);
+		vB = static_cast<float>(-kb / (2. * (1. - kr)) * cScale);
+	}
+};
+
+const FloatCoefficients &getFloatCoefficients(YUVConverter::Matrix matrix) {
+	static const FloatCoefficients bt601(.299, .114);
+	static const FloatCoefficients bt709(.2126, .0722);
+
+	return matrix == YUVConverter::Matrix::BT709 ? bt709 : bt601;
+}
+
+const float yOffset16 = 16.f * 256.f;
+const float cOffset16 = 128.f * 256.f;
+
+inline float halfToFloat(uint16_t half) {
+	const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+	uint32_t bits;
+
+	if(exponent == 0x1F) {
+		// Infinity and NaN
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	} else if(exponent != 0) {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	} else if(mantissa == 0) {
+		bits = sign;
+	} else {
+		// Subnormal, normalized for the float
+		exponent = 113;
+
+		while((mantissa & 0x400) == 0) {
+			mantissa <<= 1;
+			--exponent;
+		}
+
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+inline float clampUnit(float value) {
+	// NaN ends up at 0
+	return value > 0.f ? (value < 1.f ? value : 1.f) : 0.f;
+}
+
+/// Reads a pixel as normalized RGBA
+inline void loadPixel(const uint8_t * src, bool isHalfFloat, float * rgba) {
+	const uint16_t * components = reinterpret_cast<const uint16_t *>(src);
+
+	for(int i = 0; i < 4; ++i)
+		rgba[i] = clampUnit(isHalfFloat ? halfToFloat(components[i]) : components[i] / 65535.f);
+}
+
+inline uint16_t toUnsigned16(float value) {
+	return static_cast<uint16_t>(std::min(std::max(value, 0.f), 65535.f) + .5f);
+}
+
+/// Converts two horizontal pixels to P216
+inline void convertPair16(const uint8_t * src, bool isHalfFloat,
+						  uint16_t * luma, uint16_t * chroma, uint16_t * alpha,
+						  const FloatCoefficients &c) {
+	float p0[4], p1[4];
+	loadPixel(src, isHalfFloat, p0);
+	loadPixel(src + 8, isHalfFloat, p1);
+
+	const float r = (p0[0] + p1[0]) * .5f;
+	const float g = (p0[1] + p1[1]) * .5f;
+	const float b = (p0[2] + p1[2]) * .5f;
+
+	luma[0] = toUnsigned16(c.yR * p0[0] + c.yG * p0[1] + c.yB * p0[2] + yOffset16);
+	luma[1] = toUnsigned16(c.yR * p1[0] + c.yG * p1[1] + c.yB * p1[2] + yOffset16);
+	chroma[0] = toUnsigned16(c.uR * r + c.uG * g + c.uB * b + cOffset16);
+	chroma[1] = toUnsigned16(c.vR * r + c.vG * g + c.vB * b + cOffset16);
+
+	if(alpha) {
+		alpha[0] = toUnsigned16(p0[3] * 65535.f);
+		alpha[1] = toUnsigned16(p1[3] * 65535.f);
+	}
+}
+
+/// Reads 4 pixels as normalized RGBA, one vector per pixel
+template<bool isHalfFloat>
+inline void load4(const uint8_t * src, __m128 * pixels) {
+	const __m128i p01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+	const __m128i p23 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+
+	if(isHalfFloat) {
+#if defined(__F16C__) || defined(__AVX2__)
+		pixels[0] = _mm_cvtph_ps(p01);
+		pixels[1] = _mm_cvtph_ps(_mm_srli_si128(p01, 8));
+		pixels[2] = _mm_cvtph_ps(p23);
+		pixels[3] = _mm_cvtph_ps(_mm_srli_si128(p23, 8));
+#else
+		const uint16_t * components = reinterpret_cast<const uint16_t *>(src);
+
+		for(int i = 0; i < 4; ++i) {
+			pixels[i] = _mm_setr_ps(halfToFloat(components[i * 4]), halfToFloat(components[i * 4 + 1]),
+									halfToFloat(components[i * 4 + 2]), halfToFloat(components[i * 4 + 3]));
+		}
+#endif
+
+		// Max first, NaN ends up at 0
+		for(int i = 0; i < 4; ++i)
+			pixels[i] = _mm_min_ps(_mm_max_ps(pixels[i], zero), one);
+	} else {
+		const __m128i zeroi = _mm_setzero_si128();
+		const __m128 scale = _mm_set1_ps(1.f / 65535.f);
+
+		pixels[0] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(p01, zeroi)), scale);
+		pixels[1] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(p01, zeroi)), scale);
+		pixels[2] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(p23, zeroi)), scale);
+		pixels[3] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(p23, zeroi)), scale);
+	}
+}
+
+/// Rounds values in [0, 65535] and packs them to 16 bits, a then b. SSE2
+/// only packs signed values, they are shifted around it.
+inline __m128i packUnsigned16(__m128 a, __m128 b) {
+	const __m128 bias = _mm_set1_ps(32768.f);
+	const __m128i a32 = _mm_cvtps_epi32(_mm_sub_ps(a, bias));
+	const __m128i b32 = _mm_cvtps_epi32(_mm_sub_ps(b, bias));
+	return _mm_xor_si128(_mm_packs_epi32(a32, b32), _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+}
+
+template<bool isHalfFloat>
+inline int convertRow16(const uint8_t * src, uint16_t * luma, uint16_t * chroma, uint16_t * alpha,
+						int width, const FloatCoefficients &c) {
+	const __m128 yR = _mm_set1_ps(c.yR), yG = _mm_set1_ps(c.yG), yB = _mm_set1_ps(c.yB);
+	const __m128 uR = _mm_set1_ps(c.uR), uG = _mm_set1_ps(c.uG), uB = _mm_set1_ps(c.uB);
+	const __m128 vR = _mm_set1_ps(c.vR), vG = _mm_set1_ps(c.vG), vB = _mm_set1_ps(c.vB);
+	const __m128 yOffset = _mm_set1_ps(yOffset16);
+	const __m128 cOffset = _mm_set1_ps(cOffset16);
+	const __m128 half = _mm_set1_ps(.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 max = _mm_set1_ps(65535.f);
+
+	int x = 0;
+
+	for(; x + 4 <= width; x += 4) {
+		__m128 r, g, b, a;
+		{
+			__m128 pixels[4];
+			load4<isHalfFloat>(src + x * 8, pixels);
+			_MM_TRANSPOSE4_PS(pixels[0], pixels[1], pixels[2], pixels[3]);
+			r = pixels[0];
+			g = pixels[1];
+			b = pixels[2];
+			a = pixels[3];
+		}
+
+		// Per pixel
+		const __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, yR), _mm_mul_ps(g, yG)), _mm_add_ps(_mm_mul_ps(b, yB), yOffset));
+
+		// Per pair of pixels, averaged first
+		const __m128 rPairs = _mm_add_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 0, 0)), _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 1, 1)));
+		const __m128 gPairs = _mm_add_ps(_mm_shuffle_ps(g, g, _MM_SHUFFLE(2, 2, 0, 0)), _mm_shuffle_ps(g, g, _MM_SHUFFLE(3, 3, 1, 1)));
+		const __m128 bPairs = _mm_add_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1)));
+
+		// Cb01 Cr01 Cb23 Cr23
+		const __m128 cScaleR = _mm_unpacklo_ps(uR, vR);
+		const __m128 cScaleG = _mm_unpacklo_ps(uG, vG);
+		const __m128 cScaleB = _mm_unpacklo_ps(uB, vB);
+
+		__m128 cbcr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rPairs, cScaleR), _mm_mul_ps(gPairs, cScaleG)), _mm_mul_ps(bPairs, cScaleB));
+		cbcr = _mm_add_ps(_mm_mul_ps(cbcr, half), cOffset);
+
+		const __m128i packed = packUnsigned16(_mm_min_ps(_mm_max_ps(y, zero), max),
+											  _mm_min_ps(_mm_max_ps(cbcr, zero), max));
+
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(luma + x), packed);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(chroma + x), _mm_srli_si128(packed, 8));
+
+		if(alpha)
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(alpha + x), packUnsigned16(_mm_mul_ps(a, max), zero));
+	}
+
+	return x;
+}
+
+template<bool isHalfFloat>
+inline int narrowRow(const uint8_t * src, uint8_t * dst, int width) {
+	const __m128 scale = _mm_set1_ps(255.f);
+	int x = 0;
+
+	for(; x + 4 <= width; x += 4) {
+		__m128 pixels[4];
+		load4<isHalfFloat>(src + x * 8, pixels);
+
+		// RGBA to BGRA while still in floats
+		__m128i bgra[4];
+
+		for(int i = 0; i < 4; ++i)
+			bgra[i] = _mm_cvtps_epi32(_mm_mul_ps(_mm_shuffle_ps(pixels[i], pixels[i], _MM_SHUFFLE(3, 0, 1, 2)), scale));
+
+		const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(bgra[0], bgra[1]), _mm_packs_epi32(bgra[2], bgra[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), packed);
+	}
+
+	return x;
+}
+
+}  // namespace
+
+YUVConverter::Matrix YUVConverter::matrixFor(int height) {
+	return height >= 720 ? Matrix::BT709 : Matrix::BT601;
+}
+
+void YUVConverter::bgraToUYVY(const uint8_t * src, int srcStride,
+							  uint8_t * dst, int dstStride,
+							  uint8_t * alpha, int alphaStride,
+							  int width, int height,
+							  Matrix matrix,
+							  WorkerPool * pool) {
+	if(pool == nullptr) {
+		bgraToUYVYRows(src, srcStride, dst, dstStride, alpha, alphaStride, width, matrix, 0, height);
+		return;
+	}
+
+	pool->parallelFor(height, [&](int begin, int end) {
+		bgraToUYVYRows(src, srcStride, dst, dstStride, alpha, alphaStride, width, matrix, begin, end);
+	});
+}
+
+void YUVConverter::bgraToUYVYRows(const uint8_t * src, int srcStride,
+								  uint8_t * dst, int dstStride,
+								  uint8_t * alpha, int alphaStride,
+								  int width, Matrix matrix,
+								  int rowBegin, int rowEnd) {
+	const Coefficients &coefficients = getCoefficients(matrix);
+	const Kernel kernel(coefficients);
+	const bool useAVX2 = CPUFeatures::hasAVX2();
+
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * srcRow = src + y * srcStride;
+		uint8_t * dstRow = dst + y * dstStride;
+
+		const int converted = useAVX2 ? convertRowAVX2(srcRow, dstRow, width, coefficients) : convertRow(srcRow, dstRow, width, kernel);
+
+		for(int x = converted; x + 1 < width; x += 2) {
+			convertPair(srcRow + x * 4, srcRow + x * 4 + 4, dstRow + x * 2, coefficients);
+		}
+
+		if(alpha == nullptr)
+			continue;
+
+		uint8_t * alphaRow = alpha + y * alphaStride;
+
+		const int extracted = useAVX2 ? extractAlphaAVX2(srcRow, alphaRow, width) : extractAlpha(srcRow, alphaRow, width);
+
+		for(int x = extracted; x < width; ++x) {
+			alphaRow[x] = srcRow[x * 4 + 3];
+		}
+	}
+}
+
+void YUVConverter::rgba16ToP216(const uint8_t * src, int srcStride, bool isHalfFloat,
+								uint8_t * dst, int dstStride,
+								uint8_t * alpha, int alphaStride,
+								int width, int height,
+								Matrix matrix,
+								WorkerPool * pool) {
+	// The CbCr plane follows the luma one
+	uint8_t * chroma = dst + static_cast<size_t>(dstStride) * height;
+
+	if(pool == nullptr) {
+		rgba16ToP216Rows(src, srcStride, isHalfFloat, dst, chroma, dstStride, alpha, alphaStride, width, matrix, 0, height);
+		return;
+	}
+
+	pool->parallelFor(height, [&](int begin, int end) {
+		rgba16ToP216Rows(src, srcStride, isHalfFloat, dst, chroma, dstStride, alpha, alphaStride, width, matrix, begin, end);
+	});
+}
+
+void YUVConverter::rgba16ToP216Rows(const uint8_t * src, int srcStride, bool isHalfFloat,
+									uint8_t * luma, uint8_t * chroma, int dstStride,
+									uint8_t * alpha, int alphaStride,
+									int width, Matrix matrix,
+									int rowBegin, int rowEnd) {
+	const FloatCoefficients &coefficients = getFloatCoefficients(matrix);
+
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * srcRow = src + static_cast<size_t>(y) * srcStride;
+		uint16_t * lumaRow = reinterpret_cast<uint16_t *>(luma + static_cast<size_t>(y) * dstStride);
+		uint16_t * chromaRow = reinterpret_cast<uint16_t *>(chroma + static_cast<size_t>(y) * dstStride);
+		uint16_t * alphaRow = alpha ? reinterpret_cast<uint16_t *>(alpha + static_cast<size_t>(y) * alphaStride) : nullptr;
+
+		const int converted = isHalfFloat ?
+			convertRow16<true>(srcRow, lumaRow, chromaRow, alphaRow, width, coefficients) :
+			convertRow16<false>(srcRow, lumaRow, chromaRow, alphaRow, width, coefficients);
+
+		for(int x = converted; x + 1 < width; x += 2) {
+			convertPair16(srcRow + x * 8, isHalfFloat,
+						  lumaRow + x, chromaRow + x, alphaRow ? alphaRow + x : nullptr,
+						  coefficients);
+		}
+	}
+}
+
+void YUVConverter::rgba16ToBGRA(const uint8_t * src, int srcStride, bool isHalfFloat,
+								uint8_t * dst, int dstStride,
+								int width, int height,
+								WorkerPool * pool) {
+	if(pool == nullptr) {
+		rgba16ToBGRARows(src, srcStride, isHalfFloat, dst, dstStride, width, 0, height);
+		return;
+	}
+
+	pool->parallelFor(height, [&](int begin, int end) {
+		rgba16ToBGRARows(src, srcStride, isHalfFloat, dst, dstStride, width, begin, end);
+	});
+}
+
+void YUVConverter::rgba16ToBGRARows(const uint8_t * src, int srcStride, bool isHalfFloat,
+									uint8_t * dst, int dstStride,
+									int width,
+									int rowBegin, int rowEnd) {
+	for(int y = rowBegin; y < rowEnd; ++y) {
+		const uint8_t * srcRow = src + static_cast<size_t>(y) * srcStride;
+		uint8_t * dstRow = dst + static_cast<size_t>(y) * dstStride;
+
+		const int narrowed = isHalfFloat ? narrowRow<true>(srcRow, dstRow, width) : narrowRow<false>(srcRow, dstRow, width);
+
+		for(int x = narrowed; x < width; ++x) {
+			float rgba[4];
+			loadPixel(srcRow + x * 8, isHalfFloat, rgba);
+
+			dstRow[x * 4 + 0] = static_cast<uint8_t>(rgba[2] * 255.f + .5f);
+			dstRow[x * 4 + 1] = static_cast<uint8_t>(rgba[1] * 255.f + .5f);
+			dstRow[x * 4 + 2] = static_cast<uint8_t>(rgba[0] * 255.f + .5f);
+			dstRow[x * 4 + 3] = static_cast<uint8_t>(rgba[3] * 255.f + .5f);
+		}
+	}
+}
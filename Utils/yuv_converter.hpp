@@ -0,0 +1,106 @@
+//
+//  yuv_converter.hpp
+//  NDI
+//
+//  Created by Valentin Dufois on 2026-10-18.
+//  Copyright © 2026 Derivative. All rights reserved.
+//
+
+#ifndef yuv_converter_hpp
+#define yuv_converter_hpp
+
+#include <cstdint>
+
+class WorkerPool;
+
+/// Converts 8 bits BGRA frames to the 4:2:2 layouts NDI sends natively,
+/// sparing the encoder its own conversion. Values are video range.
+///
+/// 16 bits RGBA frames, fixed or half float, are converted to the 16 bits
+/// semi-planar layouts without going through 8 bits, so deep sources reach
+/// the receivers intact.
+class YUVConverter
+{
+public:
+	enum class Matrix {
+		BT601,
+		BT709
+	};
+
+	/// The matrix NDI expects for frames of the given height: BT.601 for
+	/// SD, BT.709 above
+	static Matrix matrixFor(int height);
+
+	/// Converts a BGRA frame to UYVY, splitting rows over the given pool.
+	/// Each pair of horizontal pixels shares its chroma, width must be even.
+	/// @param src The source pixels
+	/// @param srcStride Size in bytes of a source row
+	/// @param dst The UYVY pixels, two bytes per pixel
+	/// @param dstStride Size in bytes of a UYVY row
+	/// @param alpha If not null, receives the alpha channel, one byte per
+	/// pixel, for UYVA frames
+	/// @param alphaStride Size in bytes of an alpha row
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	static void bgraToUYVY(const uint8_t * src, int srcStride,
+						   uint8_t * dst, int dstStride,
+						   uint8_t * alpha, int alphaStride,
+						   int width, int height,
+						   Matrix matrix,
+						   WorkerPool * pool);
+
+	/// Converts a range of rows. Safe to call concurrently on different
+	/// ranges.
+	static void bgraToUYVYRows(const uint8_t * src, int srcStride,
+							   uint8_t * dst, int dstStride,
+							   uint8_t * alpha, int alphaStride,
+							   int width, Matrix matrix,
+							   int rowBegin, int rowEnd);
+
+	/// Converts a 16 bits RGBA frame to P216, splitting rows over the given
+	/// pool. Each pair of horizontal pixels shares its chroma, width must be
+	/// even. Float values outside of [0, 1] are clamped.
+	/// @param src The source pixels, in RGBA order
+	/// @param srcStride Size in bytes of a source row
+	/// @param isHalfFloat If the source components are half floats rather
+	/// than unsigned integers
+	/// @param dst The luma plane, immediately followed by the interleaved
+	/// CbCr plane, two bytes per component
+	/// @param dstStride Size in bytes of a row of either plane
+	/// @param alpha If not null, receives the alpha channel, two bytes per
+	/// pixel, for PA16 frames
+	/// @param alphaStride Size in bytes of an alpha row
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	static void rgba16ToP216(const uint8_t * src, int srcStride, bool isHalfFloat,
+							 uint8_t * dst, int dstStride,
+							 uint8_t * alpha, int alphaStride,
+							 int width, int height,
+							 Matrix matrix,
+							 WorkerPool * pool);
+
+	/// Converts a range of rows to P216. Safe to call concurrently on
+	/// different ranges.
+	/// @param luma The luma plane
+	/// @param chroma The CbCr plane
+	static void rgba16ToP216Rows(const uint8_t * src, int srcStride, bool isHalfFloat,
+								 uint8_t * luma, uint8_t * chroma, int dstStride,
+								 uint8_t * alpha, int alphaStride,
+								 int width, Matrix matrix,
+								 int rowBegin, int rowEnd);
+
+	/// Narrows a 16 bits RGBA frame to 8 bits BGRA, splitting rows over the
+	/// given pool
+	/// @param pool The pool to run on. Runs on the calling thread if null.
+	static void rgba16ToBGRA(const uint8_t * src, int srcStride, bool isHalfFloat,
+							 uint8_t * dst, int dstStride,
+							 int width, int height,
+							 WorkerPool * pool);
+
+	/// Narrows a range of rows. Safe to call concurrently on different
+	/// ranges.
+	static void rgba16ToBGRARows(const uint8_t * src, int srcStride, bool isHalfFloat,
+								 uint8_t * dst, int dstStride,
+								 int width,
+								 int rowBegin, int rowEnd);
+};
+
+#endif /* yuv_converter_hpp */